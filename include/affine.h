@@ -0,0 +1,36 @@
+#ifndef AFFINE_H
+#define AFFINE_H
+
+#include <cstddef>
+#include "figure.h"
+
+// x' = a * x + b * y + tx
+// y' = c * x + d * y + ty
+struct AffineTransform {
+    double a, b, c, d, tx, ty;
+
+    AffineTransform(double a = 1, double b = 0, double c = 0, double d = 1, double tx = 0, double ty = 0)
+        : a(a), b(b), c(c), d(d), tx(tx), ty(ty) {}
+
+    static AffineTransform identity();
+    static AffineTransform translation(double dx, double dy);
+    static AffineTransform rotation(double angle, const Point& center = Point(0, 0));
+    static AffineTransform scaling(double sx, double sy, const Point& center = Point(0, 0));
+
+    // Сначала *this, затем next.
+    AffineTransform then(const AffineTransform& next) const;
+    Point apply(const Point& p) const { return Point(a * p.x + b * p.y + tx, c * p.x + d * p.y + ty); }
+    double determinant() const { return a * d - b * c; }
+    bool isInvertible() const { return determinant() != 0; }
+    // Поворот + равномерное масштабирование (+ отражение): сохраняет углы и отношения длин.
+    bool isSimilarity() const { return (a == d && b == -c) || (a == -d && b == c); }
+    // Оси остаются параллельными осям - ограничивающий прямоугольник переносится напрямую.
+    bool isAxisAligned() const { return b == 0 && c == 0; }
+};
+
+namespace GeometryUtils {
+    // Применяет преобразование к массиву точек (SSE2, если доступно).
+    void transformPoints(Point* points, size_t count, const AffineTransform& m);
+}
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "figure.h"
+#include "convex_polygon.h"
+#include "figure_array.h"
+
+typedef std::pair<size_t, size_t> FigurePair;
+
+namespace Collision {
+    // Теорема о разделяющей оси. Касание по границе пересечением не считается.
+    bool overlaps(const ConvexPolygon& a, const ConvexPolygon& b);
+    bool overlaps(const Figure& a, const Figure& b);
+
+    // Sweep and prune по оси X: пары с пересекающимися рамками, (i < j).
+    std::vector<FigurePair> candidatePairs(const std::vector<BoundingBox>& boxes);
+
+    // Площадь пересечения выпуклых фигур (отсечение Сазерленда-Ходжмана
+    // на массивах фиксированного размера, без выделения памяти).
+    double intersectionArea(const ConvexPolygon& a, const ConvexPolygon& b);
+    double intersectionArea(const Figure& a, const Figure& b);
+
+    std::vector<ConvexPolygon> snapshot(const FigureArray& figures);
+
+    // Все пары пересекающихся фигур, (i < j), по возрастанию.
+    std::vector<FigurePair> findOverlaps(const FigureArray& figures);
+    std::vector<FigurePair> findOverlaps(const std::vector<ConvexPolygon>& polygons);
+
+    // Площади пересечения для списка пар, вычисленные параллельно.
+    std::vector<double> intersectionAreas(const FigureArray& figures, const std::vector<FigurePair>& pairs);
+    std::vector<double> intersectionAreas(const std::vector<ConvexPolygon>& polygons,
+                                          const std::vector<FigurePair>& pairs);
+}
+
+#endif
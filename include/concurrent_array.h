@@ -0,0 +1,119 @@
+#ifndef CONCURRENT_ARRAY_H
+#define CONCURRENT_ARRAY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include "epoch.h"
+#include "figure.h"
+#include "figure_array.h"
+
+// Многоверсионный массив фигур для многих читателей и одного писателя за
+// раз. Каждое изменение создаёт версию с номером: писатель изменяет копию
+// (FigureArray копирует только таблицу блоков и затронутые блоки и фигуры)
+// и публикует её.
+//
+// Короткий обход - read(): читатель закрепляет эпоху и идёт по текущей
+// версии по константным ссылкам, без блокировок и счётчиков ссылок.
+// Долгий отчёт - snapshot(): версия закрепляется одним атомарным счётчиком
+// на весь снимок и остаётся неизменной, пока он жив; эпоха при этом не
+// держится, так что другие версии освобождаются как обычно.
+//
+// Версия, которая уже не текущая и не закреплена снимком, отдаётся
+// EpochReclaimer и освобождается (с удалёнными фигурами), когда закончены
+// обходы всех читателей, которые могли её видеть.
+class ConcurrentFigureArray {
+private:
+    struct Version {
+        uint64_t number;
+        FigureArray figures;
+        std::atomic<size_t> refs; // снимки + 1, пока версия текущая
+
+        Version(uint64_t number, const FigureArray& figures) : number(number), figures(figures), refs(1) {}
+    };
+
+    mutable EpochReclaimer reclaimer;
+    std::atomic<Version*> current;
+    std::mutex writer;
+    mutable std::mutex versionsMutex;
+    mutable std::map<uint64_t, Version*> versions; // версии с refs > 0
+
+    static bool acquire(Version* version);
+    void release(Version* version) const;
+    void publish(Version* next);
+
+public:
+    class ReadGuard {
+    private:
+        EpochReclaimer::Guard guard;
+        const Version* pinned;
+
+    public:
+        ReadGuard(EpochReclaimer& reclaimer, const std::atomic<Version*>& current)
+            : guard(reclaimer), pinned(current.load()) {}
+        uint64_t version() const { return pinned->number; }
+        const FigureArray& operator*() const { return pinned->figures; }
+        const FigureArray* operator->() const { return &pinned->figures; }
+    };
+
+    // Должен быть уничтожен раньше массива.
+    class Snapshot {
+    private:
+        const ConcurrentFigureArray* owner;
+        Version* pinned;
+
+    public:
+        Snapshot(const ConcurrentFigureArray* owner, Version* pinned) : owner(owner), pinned(pinned) {}
+        Snapshot(Snapshot&& other) noexcept : owner(other.owner), pinned(other.pinned) { other.pinned = nullptr; }
+        Snapshot& operator=(Snapshot&& other) noexcept;
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+        ~Snapshot();
+
+        uint64_t version() const { return pinned->number; }
+        const FigureArray& operator*() const { return pinned->figures; }
+        const FigureArray* operator->() const { return &pinned->figures; }
+    };
+
+    ConcurrentFigureArray();
+    ConcurrentFigureArray(const ConcurrentFigureArray&) = delete;
+    ConcurrentFigureArray& operator=(const ConcurrentFigureArray&) = delete;
+    ~ConcurrentFigureArray();
+
+    // Закреплённая эпоха; держать недолго - пока она жива, старые версии не освобождаются.
+    ReadGuard read() const { return ReadGuard(reclaimer, current); }
+    Snapshot snapshot() const;
+    // Версия, которую ещё держит снимок или которая текущая; иначе std::out_of_range.
+    Snapshot snapshot(uint64_t version) const;
+    uint64_t version() const { return read().version(); }
+
+    // Изменения edit(FigureArray&) становятся одной новой версией; её номер
+    // возвращается. Исключение из edit оставляет опубликованную версию прежней.
+    template <typename Edit>
+    uint64_t update(Edit edit) {
+        std::lock_guard<std::mutex> lock(writer);
+        const Version* base = current.load();
+        std::unique_ptr<Version> next(new Version(base->number + 1, base->figures));
+        edit(next->figures);
+        uint64_t number = next->number;
+        publish(next.release());
+        return number;
+    }
+
+    uint64_t addFigure(std::shared_ptr<const Figure> fig);
+    uint64_t removeFigure(size_t index);
+    uint64_t setVertex(size_t index, size_t vertex, const Point& p);
+    uint64_t replaceFigure(size_t index, std::shared_ptr<const Figure> fig);
+
+    // Освобождает версии, которых уже никто не видит; вызывается и после каждой записи.
+    size_t reclaim();
+    // Версий, ожидающих освобождения.
+    size_t pendingVersions() { return reclaimer.pending(); }
+    // Живые версии: текущая и закреплённые снимками.
+    size_t retainedVersions() const;
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef CONVEX_HULL_H
+#define CONVEX_HULL_H
+
+#include <cstddef>
+#include <vector>
+#include "figure.h"
+#include "figure_array.h"
+
+// Выпуклая оболочка вершин фигур, обход против часовой стрелки без
+// коллинеарных вершин. Может дополняться без пересчёта с нуля.
+class ConvexHull {
+private:
+    std::vector<Point> hull;
+
+public:
+    ConvexHull() = default;
+    // Блоки фигур обрабатываются параллельно (фильтр Экла-Туссена + монотонная
+    // цепочка), затем оболочки блоков объединяются.
+    static ConvexHull of(const FigureArray& figures);
+    static ConvexHull of(std::vector<Point> points);
+
+    // Точки внутри текущей оболочки отбрасываются; если таких нет, оболочка
+    // не меняется, иначе перестраивается только по её вершинам и новым точкам.
+    void addPoints(const Point* points, size_t count);
+    void addFigure(const Figure& fig);
+    void addFigures(const FigureArray& figures);
+
+    bool contains(const Point& p) const;
+    const std::vector<Point>& vertices() const { return hull; }
+    size_t size() const { return hull.size(); }
+    bool empty() const { return hull.empty(); }
+    double area() const;
+    BoundingBox bounds() const;
+};
+
+#endif
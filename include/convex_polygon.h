@@ -0,0 +1,29 @@
+#ifndef CONVEX_POLYGON_H
+#define CONVEX_POLYGON_H
+
+#include <cstddef>
+#include "figure.h"
+
+// Плоская копия вершин выпуклой фигуры для геометрических алгоритмов:
+// без виртуальных вызовов и выделений памяти, обход против часовой стрелки.
+struct ConvexPolygon {
+    static const size_t MAX_VERTICES = 16;
+    Point vertices[MAX_VERTICES];
+    size_t count = 0;
+
+    static ConvexPolygon fromFigure(const Figure& fig);
+
+    void add(const Point& p);
+    const Point& operator[](size_t index) const { return vertices[index]; }
+    double signedArea() const;
+    double area() const;
+    double perimeter() const;
+    Point geometricCenter() const;
+    BoundingBox bounds() const;
+    bool contains(const Point& p) const;
+    // Расстояние до точки; 0, если точка внутри или на границе.
+    double distanceTo(const Point& p) const;
+    void makeCounterClockwise();
+};
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef COVERED_AREA_H
+#define COVERED_AREA_H
+
+#include <vector>
+#include "convex_polygon.h"
+
+namespace Coverage {
+    // Площадь объединения выпуклых многоугольников. Заметающая прямая делит
+    // плоскость на вертикальные полосы по абсциссам вершин и точек пересечения
+    // рёбер; внутри полосы длина сечения объединения линейна, поэтому площадь
+    // полосы считается точно по её середине. Рёбра, пересекающие полосу,
+    // лежат в упорядоченном по высоте дереве с глубиной покрытия в узлах; на
+    // границе полосы в нём меняются только кончившиеся, начавшиеся и
+    // пересёкшиеся рёбра, а длина сечения берётся из корня.
+    //
+    // Сложность: O((N + K) log N), где N - число вершин, K - пересечений
+    // рёбер (плюс поиск пар-кандидатов по рамкам). В параллельном режиме
+    // полосы делятся на непрерывные блоки по потокам, и каждый блок заново
+    // строит дерево для своей первой полосы - ещё O(N log N) на поток.
+    double unionArea(const std::vector<ConvexPolygon>& polygons, bool parallel = false);
+}
+
+#endif
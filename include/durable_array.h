@@ -0,0 +1,88 @@
+#ifndef DURABLE_ARRAY_H
+#define DURABLE_ARRAY_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "figure.h"
+#include "figure_array.h"
+#include "figure_log.h"
+
+struct CheckpointReport {
+    bool running = false;
+    uint64_t sequence = 0;     // последняя запись журнала, вошедшая в снимок
+    size_t written = 0;        // фигур записано в снимок
+    size_t total = 0;          // фигур в снимке
+    double pauseMillis = 0;    // сколько изменения ждали захвата снимка
+    double durationMillis = 0; // от захвата до готового снимка (для завершённой)
+    std::string error;         // пусто, если последняя контрольная точка удалась
+};
+
+// FigureArray как основное хранилище: каталог содержит снимок
+// (MappedFigureStore) и сегменты журнала изменений после него. При открытии
+// снимок загружается, сегменты проигрываются по порядку. Изменения
+// применяются в памяти сразу, долговечны после commit(); одновременные
+// commit() из разных потоков объединяются в один fdatasync.
+//
+// Контрольная точка берёт снимок массива (копия таблицы блоков, см.
+// FigureArray) и переключает журнал на новый сегмент - изменения ждут только
+// этого; снимок пишется в фоновом потоке. Дополнительная память - блоки и
+// фигуры, изменённые, пока снимок пишется.
+class DurableFigureArray {
+private:
+    std::string directory;
+    FigureArray figures;
+    std::shared_ptr<FigureLog> log;
+    uint64_t generation = 0;       // номер активного сегмента журнала
+    uint64_t oldestGeneration = 0; // самый старый ещё не удалённый сегмент
+    size_t compactAfterBytes;
+    std::mutex mutex;              // изменения массива и переключение сегментов
+
+    std::mutex checkpointMutex;    // запуск фонового потока и ожидание его
+    std::thread checkpointThread;
+    std::atomic<bool> checkpointRunning;
+    std::atomic<size_t> checkpointWritten;
+    mutable std::mutex reportMutex;
+    CheckpointReport report;
+
+    std::string snapshotPath() const { return directory + "/snapshot.bin"; }
+    std::string segmentPath(uint64_t generation) const;
+    void apply(const LogEntry& entry);
+    void writeSnapshot(FigureArray table, uint64_t sequence, uint64_t generation,
+                       std::chrono::steady_clock::time_point started);
+
+public:
+    static const size_t DEFAULT_COMPACT_BYTES = 64 << 20;
+
+    explicit DurableFigureArray(const std::string& directory, size_t compactAfterBytes = DEFAULT_COMPACT_BYTES);
+    // Дожидается фоновой контрольной точки.
+    ~DurableFigureArray();
+
+    // Массив хранит копию fig: дальнейшие изменения fig не попадают ни в него, ни в журнал.
+    void addFigure(std::shared_ptr<const Figure> fig);
+    // Несуществующий индекс - ничего не делает и не пишется в журнал, как у FigureArray.
+    void removeFigure(size_t index);
+    void setVertex(size_t index, size_t vertex, const Point& p);
+
+    // Когда активный сегмент журнала больше compactAfterBytes, запускает контрольную точку.
+    void commit();
+    // false, если контрольная точка уже идёт.
+    bool startCheckpoint();
+    void waitForCheckpoint();
+    CheckpointReport checkpointReport() const;
+    // Контрольная точка с ожиданием; ошибка записи - std::runtime_error.
+    void compact();
+
+    // Только для чтения; не одновременно с изменениями.
+    const FigureArray& array() const { return figures; }
+    // Размер активного сегмента журнала.
+    size_t logSize();
+};
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef EDIT_JOURNAL_H
+#define EDIT_JOURNAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include "figure.h"
+#include "figure_array.h"
+
+// Журнал отмены и повтора изменений FigureArray. Хранит не копии фигур,
+// а обратимые изменения: старую и новую вершину, указатель на добавленную,
+// удалённую или заменённую фигуру. Отмена и повтор шага стоят O(1) сверх
+// самой операции над массивом. Когда журнал превышает memoryBudget байт,
+// самые старые шаги забываются. Все изменения массива должны идти через журнал.
+class EditJournal {
+private:
+    struct Delta {
+        enum Kind : uint8_t { ADD, REMOVE, SET_VERTEX, REPLACE };
+
+        Kind kind;
+        uint32_t vertex = 0;
+        uint64_t step = 0;  // шаги отменяются целиком
+        size_t index = 0;
+        Point before, after;
+        std::shared_ptr<const Figure> figure;      // ADD, REMOVE; REPLACE - прежняя фигура
+        std::shared_ptr<const Figure> replacement; // REPLACE - новая фигура
+    };
+
+    FigureArray& figures;
+    std::deque<Delta> history;
+    size_t applied = 0; // history[0, applied) можно отменить, остальное - повторить
+    size_t budget;
+    size_t used = 0;
+    uint64_t nextStep = 1;
+    uint64_t openStep = 0; // ненулевой внутри beginStep/endStep
+
+    static size_t cost(const Delta& delta);
+    void record(Delta delta);
+    void dropFront();
+    void dropBack();
+    void revert(const Delta& delta);
+    void reapply(const Delta& delta);
+
+public:
+    static const size_t DEFAULT_BUDGET = 1 << 20;
+
+    explicit EditJournal(FigureArray& figures, size_t memoryBudget = DEFAULT_BUDGET)
+        : figures(figures), budget(memoryBudget) {}
+
+    void addFigure(std::shared_ptr<const Figure> fig);
+    void removeFigure(size_t index);
+    void setVertex(size_t index, size_t vertex, const Point& p);
+    void replaceFigure(size_t index, std::shared_ptr<const Figure> fig);
+    // Переносит фигуру из source на место target одним шагом - удалением и вставкой;
+    // фигуры между ними сдвигаются. Индекс вне массива - std::out_of_range без изменений.
+    void moveFigure(size_t source, size_t target);
+
+    // Изменения между beginStep и endStep отменяются и повторяются как одно.
+    void beginStep();
+    void endStep();
+
+    bool canUndo() const { return applied > 0; }
+    bool canRedo() const { return applied < history.size(); }
+    bool undo();
+    bool redo();
+    // Приблизительный объём, занятый журналом.
+    size_t memoryUsed() const { return used; }
+};
+
+#endif
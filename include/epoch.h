@@ -0,0 +1,74 @@
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Освобождение памяти по эпохам. Читатель на время обхода закрепляет
+// текущую эпоху (Guard) - без блокировок и счётчиков ссылок. Писатель
+// сначала убирает объект из общей структуры, затем передаёт его в retire();
+// объект удаляется, когда все читатели, закреплённые до этого, отпустили эпоху.
+class EpochReclaimer {
+public:
+    static const size_t MAX_READERS = 256;
+
+private:
+    static const uint64_t IDLE = ~uint64_t(0);
+
+    struct alignas(64) Slot {
+        std::atomic<bool> busy{false};
+        std::atomic<uint64_t> epoch{IDLE};
+    };
+
+    struct Retired {
+        void* object;
+        void (*deleter)(void*);
+        uint64_t epoch;
+    };
+
+    Slot slots[MAX_READERS];
+    std::atomic<uint64_t> global{0};
+    std::mutex retiredMutex;
+    std::vector<Retired> retired;
+
+    size_t acquire();
+    bool tryAdvance();
+
+public:
+    class Guard {
+    private:
+        EpochReclaimer* owner;
+        size_t slot;
+
+    public:
+        explicit Guard(EpochReclaimer& owner);
+        Guard(Guard&& other) noexcept : owner(other.owner), slot(other.slot) { other.owner = nullptr; }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        Guard& operator=(Guard&&) = delete;
+        ~Guard();
+    };
+
+    EpochReclaimer() = default;
+    EpochReclaimer(const EpochReclaimer&) = delete;
+    EpochReclaimer& operator=(const EpochReclaimer&) = delete;
+    // Удаляет всё, что осталось; читателей к этому моменту быть не должно.
+    ~EpochReclaimer();
+
+    Guard pin() { return Guard(*this); }
+    void retire(void* object, void (*deleter)(void*));
+    template <typename T>
+    void retire(const T* object) {
+        retire(const_cast<T*>(object), [](void* p) { delete static_cast<T*>(p); });
+    }
+    // Продвигает эпоху, если все читатели её догнали, и удаляет то, что уже
+    // никто не может видеть. Возвращает число удалённых объектов.
+    size_t collect();
+    size_t pending();
+    uint64_t epoch() const { return global.load(); }
+};
+
+#endif
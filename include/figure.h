@@ -12,6 +12,30 @@ struct Point {
     bool operator==(const Point& other) const;
 };
 
+struct BoundingBox {
+    double minX, minY, maxX, maxY;
+    // По умолчанию пустой: expand() первой точкой задаёт его целиком.
+    BoundingBox();
+    BoundingBox(double minX, double minY, double maxX, double maxY);
+    bool isEmpty() const;
+    void expand(const Point& p);
+    void expand(const BoundingBox& other);
+    bool intersects(const BoundingBox& other) const;
+    bool contains(const Point& p) const;
+    bool contains(const BoundingBox& other) const;
+    double width() const { return maxX - minX; }
+    double height() const { return maxY - minY; }
+};
+
+struct AffineTransform;
+struct FigureRecord;
+class Figure;
+
+namespace FigureRecords {
+    FigureRecord encode(const Figure& fig);
+    std::shared_ptr<Figure> restore(const FigureRecord& record);
+}
+
 namespace GeometryUtils {
     const double EPSILON = 1e-9;
     double distance(const Point& a, const Point& b);
@@ -33,11 +57,37 @@ public:
     virtual Point getVertex(size_t index) const = 0;
     virtual void setVertex(size_t index, const Point& p) = 0;
     virtual void clearVertices() = 0;
+    // Базовая версия идёт через getVertex/setVertex; фигуры переопределяют её
+    // пакетным преобразованием своих вершин.
+    virtual void transform(const AffineTransform& m);
+    // Может ли transform(m) бросить исключение: геометрия ещё не проверена или
+    // m способно нарушить свойства фигуры (сдвиг ромба). Такие фигуры
+    // FigureArray::transformAll преобразует в копиях, остальные - на месте.
+    virtual bool transformMayFail(const AffineTransform& m) const;
+    // Имя конкретного типа, как в текстовом формате ("Trapezoid", ...).
+    virtual const char* typeName() const;
     virtual operator double() const;
     bool operator==(const Figure& other) const;
     bool operator!=(const Figure& other) const;
+
+protected:
+    // Состояние проверки геометрии. Записи хранилища (FigureRecords) хранят его
+    // вместе с вершинами: фигура восстанавливается такой, какой её записали.
+    enum class CheckState { PENDING = 0, VERIFIED = 1, EMPTY = 2 };
+    // По умолчанию - как после setVertex: проверка при первом использовании.
+    virtual CheckState checkState() const;
+    // Вызывается после setVertex для всех вершин.
+    virtual void restoreCheckState(CheckState state);
+
+    friend FigureRecord FigureRecords::encode(const Figure& fig);
+    friend std::shared_ptr<Figure> FigureRecords::restore(const FigureRecord& record);
 };
 
+namespace GeometryUtils {
+    double perimeter(const Figure& fig);
+    BoundingBox boundingBox(const Figure& fig);
+}
+
 std::ostream& operator<<(std::ostream& os, const Figure& fig);
 std::istream& operator>>(std::istream& is, Figure& fig);
 
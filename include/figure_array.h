@@ -0,0 +1,95 @@
+#ifndef FIGURE_ARRAY_H
+#define FIGURE_ARRAY_H
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <vector>
+#include "figure.h"
+#include "affine.h"
+#include "figure_metrics.h"
+
+// Массив фигур с копированием при записи. Фигуры хранятся блоками по
+// CHUNK_SIZE указателей; копия массива - снимок - копирует только таблицу
+// блоков и делит с оригиналом и блоки, и сами фигуры. Изменение копирует
+// блок, только если его делит другой массив, и фигуру, если её держит кто-то
+// ещё или она пришла снаружи (добавленная фигура может быть создана
+// константной). Снаружи фигуры доступны только для чтения.
+class FigureArray {
+public:
+    static const size_t CHUNK_SHIFT = 10;
+    static const size_t CHUNK_SIZE = size_t(1) << CHUNK_SHIFT;
+
+private:
+    // writable - фигуру создал сам массив (clone), она не константна, и менять
+    // её на месте законно; фигуры, пришедшие снаружи, перед изменением копируются.
+    struct Entry {
+        std::shared_ptr<const Figure> figure;
+        bool writable;
+
+        Entry(std::shared_ptr<const Figure> figure = nullptr, bool writable = false)
+            : figure(std::move(figure)), writable(writable) {}
+    };
+    typedef std::vector<Entry> Chunk;
+
+    std::vector<std::shared_ptr<Chunk>> chunks;
+    size_t count = 0;
+
+    const std::shared_ptr<const Figure>& slot(size_t index) const {
+        return (*chunks[index >> CHUNK_SHIFT])[index & (CHUNK_SIZE - 1)].figure;
+    }
+    Chunk& mutableChunk(size_t chunk);
+    Figure& mutableFigure(size_t index);
+    void transformFigures(const AffineTransform& m, std::vector<FigureMetrics>* metrics);
+
+public:
+    class const_iterator {
+    private:
+        const FigureArray* array;
+        size_t index;
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef std::shared_ptr<const Figure> value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const std::shared_ptr<const Figure>* pointer;
+        typedef const std::shared_ptr<const Figure>& reference;
+
+        const_iterator(const FigureArray* array, size_t index) : array(array), index(index) {}
+        reference operator*() const { return array->slot(index); }
+        pointer operator->() const { return &array->slot(index); }
+        const_iterator& operator++() { ++index; return *this; }
+        const_iterator operator++(int) { const_iterator old = *this; ++index; return old; }
+        bool operator==(const const_iterator& other) const { return index == other.index; }
+        bool operator!=(const const_iterator& other) const { return index != other.index; }
+    };
+
+    void addFigure(std::shared_ptr<const Figure> fig);
+    // index == size() - добавление в конец.
+    void insertFigure(size_t index, std::shared_ptr<const Figure> fig);
+    void removeFigure(size_t index);
+    void setVertex(size_t index, size_t vertex, const Point& p);
+    void replaceFigure(size_t index, std::shared_ptr<const Figure> fig);
+    void printAll() const;
+    double totalArea() const;
+    // Площадь объединения: перекрытия учитываются один раз.
+    double coveredArea(bool parallel = false) const;
+    size_t size() const { return count; }
+    const std::shared_ptr<const Figure>& at(size_t index) const;
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, count); }
+
+    // Характеристики всех фигур, вычисленные параллельно.
+    std::vector<FigureMetrics> metrics() const;
+    // Применяет m ко всем фигурам параллельно, на месте; копируются только
+    // фигуры, которые делит с массивом кто-то ещё. Всё или ничего: если хоть
+    // одна фигура после преобразования некорректна (ромб под сдвигом), массив
+    // не меняется, а исключение пробрасывается.
+    void transformAll(const AffineTransform& m);
+    // То же, с согласованным обновлением ранее вычисленных metrics().
+    void transformAll(const AffineTransform& m, std::vector<FigureMetrics>& metrics);
+
+    void demonstrateOperations();
+};
+
+#endif
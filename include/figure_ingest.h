@@ -0,0 +1,93 @@
+#ifndef FIGURE_INGEST_H
+#define FIGURE_INGEST_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <queue>
+#include <vector>
+#include "figure.h"
+#include "figure_array.h"
+
+// Приём фигур от многих потоков-производителей в одного потребителя.
+// Каждый производитель копит фигуры в своём буфере (Producer) и публикует
+// его целиком одной CAS-операцией в общий стек пакетов - без блокировок и без
+// общих счётчиков на фигуру. Потребитель забирает все пакеты разом (exchange)
+// и добавляет фигуры в массив. В упорядоченном режиме фигуры выдаются строго
+// по номерам, начиная с firstSequence; пропущенный номер задерживает
+// следующие, а повторный или уже пройденный отбрасывается (staleCount).
+class FigureIngest {
+private:
+    struct Item {
+        uint64_t sequence;
+        std::shared_ptr<const Figure> figure;
+        uint64_t arrival; // порядок прихода к потребителю: из повторов выигрывает первый
+    };
+
+    struct Batch {
+        std::vector<Item> items;
+        Batch* next = nullptr;
+    };
+
+    struct Later {
+        bool operator()(const Item& a, const Item& b) const {
+            return a.sequence != b.sequence ? a.sequence > b.sequence : a.arrival > b.arrival;
+        }
+    };
+
+    std::atomic<Batch*> head{nullptr};
+    std::atomic<size_t> producers{0};
+    bool ordered;
+    uint64_t expected;
+    std::priority_queue<Item, std::vector<Item>, Later> waiting;
+    size_t stale = 0;
+    uint64_t arrivals = 0;
+
+    void publish(Batch* batch);
+
+public:
+    static const size_t DEFAULT_BATCH = 256;
+
+    // Буфер одного производителя; сам по себе не потокобезопасен - один на поток.
+    class Producer {
+    private:
+        FigureIngest* ingest;
+        std::unique_ptr<Batch> batch;
+        size_t batchSize;
+
+        void push(Item item);
+
+    public:
+        Producer(FigureIngest& ingest, size_t batchSize);
+        Producer(Producer&& other) noexcept;
+        Producer(const Producer&) = delete;
+        Producer& operator=(const Producer&) = delete;
+        Producer& operator=(Producer&&) = delete;
+        // Публикует остаток буфера.
+        ~Producer();
+
+        // Только для неупорядоченного приёма; иначе std::logic_error.
+        void push(std::shared_ptr<const Figure> fig);
+        void push(uint64_t sequence, std::shared_ptr<const Figure> fig);
+        void flush();
+    };
+
+    explicit FigureIngest(bool ordered = false, uint64_t firstSequence = 0)
+        : ordered(ordered), expected(firstSequence) {}
+    FigureIngest(const FigureIngest&) = delete;
+    FigureIngest& operator=(const FigureIngest&) = delete;
+    ~FigureIngest();
+
+    Producer producer(size_t batchSize = DEFAULT_BATCH) { return Producer(*this, batchSize); }
+    // Только из одного потока. Возвращает число добавленных фигур.
+    size_t drainInto(FigureArray& figures);
+    // Фигуры, ждущие пропущенного номера (упорядоченный режим).
+    size_t waitingCount() const { return waiting.size(); }
+    // Отброшенные фигуры с повторным или уже выданным номером.
+    size_t staleCount() const { return stale; }
+    // Ещё не уничтоженные производители.
+    size_t activeProducers() const { return producers.load(); }
+};
+
+#endif
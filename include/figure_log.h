@@ -0,0 +1,65 @@
+#ifndef FIGURE_LOG_H
+#define FIGURE_LOG_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "figure.h"
+#include "figure_record.h"
+
+struct LogEntry {
+    enum Op : uint8_t { ADD = 1, REMOVE = 2, SET_VERTEX = 3 };
+
+    uint64_t sequence = 0; // назначает FigureLog::append
+    Op op = ADD;
+    uint64_t index = 0;    // REMOVE, SET_VERTEX
+    uint32_t vertex = 0;   // SET_VERTEX
+    Point point;           // SET_VERTEX
+    FigureRecord figure;   // ADD
+};
+
+// Журнал упреждающей записи: append() только кладёт запись в буфер,
+// commit() дописывает буфер в файл и делает fdatasync. Пока один поток
+// сбрасывает буфер, остальные ждут и попадают в следующий общий сброс
+// (групповая фиксация). Запись - длина, контрольная сумма, номер, операция
+// и её данные; оборванный или повреждённый хвост при открытии отрезается.
+class FigureLog {
+private:
+    std::string path;
+    int fd = -1;
+    std::mutex mutex;
+    std::condition_variable flushed;
+    std::vector<unsigned char> pending;
+    uint64_t nextSequence = 1;
+    uint64_t durableSequence = 0;
+    bool flushing = false;
+    std::string failure;
+    size_t fileBytes = 0;
+
+public:
+    // Открывает или создаёт журнал и передаёт replay записи с номером больше
+    // after по порядку; новые номера продолжаются после наибольшего из них.
+    FigureLog(const std::string& path, uint64_t after, const std::function<void(const LogEntry&)>& replay);
+    ~FigureLog();
+    FigureLog(const FigureLog&) = delete;
+    FigureLog& operator=(const FigureLog&) = delete;
+
+    // Номер записи; долговечна после commit(номер).
+    uint64_t append(LogEntry entry);
+    void commit(uint64_t sequence);
+    // Всё, что добавлено к моменту вызова.
+    void commit();
+    // Очищает файл журнала; номера продолжаются. Вызывающий гарантирует,
+    // что все записи уже учтены в снимке и новых добавлений нет.
+    void reset();
+
+    uint64_t lastSequence();
+    // Размер журнала вместе с ещё не сброшенным буфером.
+    size_t size();
+};
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef FIGURE_METRICS_H
+#define FIGURE_METRICS_H
+
+#include "figure.h"
+#include "affine.h"
+
+// Заранее вычисленные характеристики фигуры.
+struct FigureMetrics {
+    double area = 0;
+    double perimeter = 0;
+    Point center;
+    BoundingBox box;
+
+    static FigureMetrics of(const Figure& fig);
+    // Обновление после fig.transform(m): площадь и центр - аналитически,
+    // периметр и рамка - аналитически, когда преобразование это позволяет.
+    void update(const AffineTransform& m, const Figure& transformed);
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef FIGURE_ORDER_H
+#define FIGURE_ORDER_H
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+#include "figure.h"
+#include "figure_array.h"
+
+enum class FigureKey { Area, Perimeter, CenterX, CenterY };
+
+namespace FigureKeys {
+    double of(const Figure& fig, FigureKey key);
+    // Ключи всех фигур, вычисленные параллельно по одному разу на фигуру.
+    std::vector<double> extract(const FigureArray& figures, FigureKey key);
+    // Перестановка индексов, упорядочивающая keys; при равных ключах - по индексу.
+    // Параллельная сортировка блоков и попарное слияние.
+    std::vector<size_t> sortedPermutation(const std::vector<double>& keys, bool descending = false);
+}
+
+// Упорядоченное представление массива: сам массив не переставляется.
+// Действительно, пока массив не изменился.
+class OrderedView {
+private:
+    const FigureArray* figures;
+    std::vector<size_t> permutation;
+    std::vector<double> keys;
+
+public:
+    class const_iterator {
+    private:
+        const OrderedView* view;
+        size_t rank;
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Figure value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const Figure* pointer;
+        typedef const Figure& reference;
+
+        const_iterator(const OrderedView* view, size_t rank) : view(view), rank(rank) {}
+        const Figure& operator*() const { return (*view)[rank]; }
+        const Figure* operator->() const { return &(*view)[rank]; }
+        const_iterator& operator++() { ++rank; return *this; }
+        const_iterator operator++(int) { const_iterator old = *this; ++rank; return old; }
+        bool operator==(const const_iterator& other) const { return rank == other.rank; }
+        bool operator!=(const const_iterator& other) const { return rank != other.rank; }
+    };
+
+    OrderedView(const FigureArray& figures, FigureKey key, bool descending = false);
+    // Ключи уже вычислены вызывающим кодом (например, из FigureArray::metrics()).
+    OrderedView(const FigureArray& figures, const std::vector<double>& keys, bool descending = false);
+
+    size_t size() const { return permutation.size(); }
+    const Figure& operator[](size_t rank) const { return *figures->at(permutation[rank]); }
+    size_t indexAt(size_t rank) const { return permutation[rank]; }
+    double keyAt(size_t rank) const { return keys[permutation[rank]]; }
+    const std::vector<size_t>& indices() const { return permutation; }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, permutation.size()); }
+};
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef FIGURE_READER_H
+#define FIGURE_READER_H
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include "figure.h"
+
+// Потоковое чтение фигур по одной: запись - имя типа и координаты вершин,
+// например "Trapezoid 0 0 4 0 3 2 1 2". Коллекция целиком не создаётся.
+class FigureReader {
+private:
+    std::istream& is;
+    size_t count = 0;
+
+public:
+    explicit FigureReader(std::istream& is) : is(is) {}
+    // false - конец потока; некорректная запись - std::runtime_error.
+    bool next(std::shared_ptr<Figure>& figure);
+    // Сколько фигур прочитано.
+    size_t position() const { return count; }
+
+    // Пустая фигура по имени типа ("Trapezoid", "Rhombus", "Pentagon").
+    static std::shared_ptr<Figure> create(const std::string& typeName);
+};
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef FIGURE_RECORD_H
+#define FIGURE_RECORD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "figure.h"
+
+// Фигура фиксированного размера без указателей: так она лежит в файле и в
+// памяти одинаково и может читаться прямо со страниц отображённого файла.
+struct FigureRecord {
+    static const uint32_t MAX_VERTICES = 5;
+
+    uint16_t type;        // FigureRecords::TRAPEZOID, ...
+    uint16_t check;       // Figure::CheckState; 0 - проверка при первом использовании
+    uint32_t vertexCount;
+    Point vertices[MAX_VERTICES];
+
+    // Без создания фигуры.
+    double area() const;
+    BoundingBox bounds() const;
+};
+
+namespace FigureRecords {
+    const uint32_t TRAPEZOID = 1;
+    const uint32_t RHOMBUS = 2;
+    const uint32_t PENTAGON = 3;
+
+    // Неизвестный тип фигуры - std::invalid_argument.
+    FigureRecord encode(const Figure& fig);
+    // Повреждённая запись - std::runtime_error; геометрия проверяется заново.
+    std::shared_ptr<Figure> decode(const FigureRecord& record);
+    // Для записей, уже принятых хранилищем (их целость - забота контрольной
+    // суммы): геометрия не проверяется заново, фигура получает то состояние
+    // проверки, с которым её записали - проверенная остаётся проверенной,
+    // непроверенная проверяется при первом использовании. Неверный тип или
+    // состояние - std::runtime_error.
+    std::shared_ptr<Figure> restore(const FigureRecord& record);
+    const char* typeName(uint32_t type);
+}
+
+#endif
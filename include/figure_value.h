@@ -0,0 +1,131 @@
+#ifndef FIGURE_VALUE_H
+#define FIGURE_VALUE_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "figure.h"
+
+// Полиморфная фигура со значимой семантикой. Фигура размером до INLINE_SIZE
+// хранится прямо в объекте, более крупные - в куче. Копирование глубокое.
+class FigureValue {
+public:
+    static const size_t INLINE_SIZE = 104;
+
+    template <typename T>
+    struct fitsInline : std::integral_constant<bool,
+        sizeof(T) <= INLINE_SIZE &&
+        alignof(T) <= alignof(std::max_align_t) &&
+        std::is_nothrow_move_constructible<T>::value> {};
+
+    FigureValue() noexcept : ops(nullptr) {}
+
+    template <typename T, typename Concrete = typename std::decay<T>::type,
+              typename = typename std::enable_if<std::is_base_of<Figure, Concrete>::value>::type>
+    FigureValue(T&& figure) : ops(nullptr) {
+        emplace<Concrete>(std::forward<T>(figure));
+    }
+
+    template <typename T, typename... Args>
+    static FigureValue make(Args&&... args) {
+        FigureValue value;
+        value.emplace<T>(std::forward<Args>(args)...);
+        return value;
+    }
+
+    FigureValue(const FigureValue& other);
+    FigureValue(FigureValue&& other) noexcept;
+    FigureValue& operator=(const FigureValue& other);
+    FigureValue& operator=(FigureValue&& other) noexcept;
+    ~FigureValue() { reset(); }
+
+    template <typename T, typename... Args>
+    T& emplace(Args&&... args) {
+        static_assert(std::is_base_of<Figure, T>::value, "FigureValue stores only Figure subclasses");
+        reset();
+        T* figure = construct<T>(typename fitsInline<T>::type(), std::forward<Args>(args)...);
+        ops = opsFor<T>(typename fitsInline<T>::type());
+        return *figure;
+    }
+
+    void reset() noexcept;
+    bool empty() const noexcept { return ops == nullptr; }
+    explicit operator bool() const noexcept { return ops != nullptr; }
+    bool isInline() const noexcept { return ops != nullptr && ops->isInline; }
+
+    Figure* get() noexcept { return ops ? ops->get(storage) : nullptr; }
+    const Figure* get() const noexcept { return ops ? ops->get(const_cast<unsigned char*>(storage)) : nullptr; }
+    Figure& operator*() { return *get(); }
+    const Figure& operator*() const { return *get(); }
+    Figure* operator->() { return get(); }
+    const Figure* operator->() const { return get(); }
+
+    // Типизированный доступ без dynamic_cast: сравнение таблицы операций.
+    template <typename T>
+    T* as() noexcept {
+        return holds<T>() ? static_cast<T*>(get()) : nullptr;
+    }
+    template <typename T>
+    const T* as() const noexcept {
+        return holds<T>() ? static_cast<const T*>(get()) : nullptr;
+    }
+    template <typename T>
+    bool holds() const noexcept {
+        return ops != nullptr && ops == opsFor<T>(typename fitsInline<T>::type());
+    }
+
+private:
+    // Собственная "таблица виртуальных функций" хранилища.
+    struct Ops {
+        Figure* (*get)(void* storage);
+        void (*copy)(const void* src, void* dst);
+        void (*move)(void* src, void* dst);
+        void (*destroy)(void* storage);
+        bool isInline;
+    };
+
+    template <typename T>
+    static const Ops* opsFor(std::true_type) {
+        static const Ops ops = {
+            [](void* s) -> Figure* { return static_cast<T*>(s); },
+            [](const void* src, void* dst) { new (dst) T(*static_cast<const T*>(src)); },
+            [](void* src, void* dst) { new (dst) T(std::move(*static_cast<T*>(src))); },
+            [](void* s) { static_cast<T*>(s)->~T(); },
+            true
+        };
+        return &ops;
+    }
+
+    template <typename T>
+    static const Ops* opsFor(std::false_type) {
+        static const Ops ops = {
+            [](void* s) -> Figure* { return *static_cast<T**>(s); },
+            [](const void* src, void* dst) { *static_cast<T**>(dst) = new T(**static_cast<T* const*>(src)); },
+            [](void* src, void* dst) {
+                *static_cast<T**>(dst) = *static_cast<T**>(src);
+                *static_cast<T**>(src) = nullptr;
+            },
+            [](void* s) { delete *static_cast<T**>(s); },
+            false
+        };
+        return &ops;
+    }
+
+    template <typename T, typename... Args>
+    T* construct(std::true_type, Args&&... args) {
+        return new (storage) T(std::forward<Args>(args)...);
+    }
+
+    template <typename T, typename... Args>
+    T* construct(std::false_type, Args&&... args) {
+        T* figure = new T(std::forward<Args>(args)...);
+        *reinterpret_cast<T**>(storage) = figure;
+        return figure;
+    }
+
+    alignas(std::max_align_t) unsigned char storage[INLINE_SIZE];
+    const Ops* ops;
+};
+
+#endif
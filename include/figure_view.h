@@ -0,0 +1,333 @@
+#ifndef FIGURE_VIEW_H
+#define FIGURE_VIEW_H
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+#include "figure.h"
+#include "figure_array.h"
+
+// Ленивые представления коллекций фигур:
+//   Views::all(array).byType<Rhombus>().filter(pred).transform(FigureMetrics::of).take(10)
+// Ничего не копируется и не создаётся заранее: все ступени выполняются за один
+// проход в момент перебора. Представление ссылается на исходную коллекцию и
+// действительно, пока она жива и не изменилась.
+
+template <typename Base, typename Predicate> class FilterView;
+template <typename Base, typename Function> class TransformView;
+template <typename Base> class TakeView;
+template <typename Base, typename T> class TypeView;
+
+template <typename Derived>
+class ViewBase {
+public:
+    template <typename Predicate>
+    FilterView<Derived, Predicate> filter(Predicate predicate) const;
+    template <typename Function>
+    TransformView<Derived, Function> transform(Function function) const;
+    TakeView<Derived> take(size_t count) const;
+    // Только фигуры ровно типа T (сравнение typeid, без dynamic_cast).
+    template <typename T>
+    TypeView<Derived, T> byType() const;
+
+    size_t count() const {
+        size_t result = 0;
+        for (auto it = derived().begin(), end = derived().end(); it != end; ++it) {
+            ++result;
+        }
+        return result;
+    }
+
+    // Материализует значения (для представлений фигур - указатели на них).
+    auto toVector() const {
+        typedef typename std::decay<typename Derived::reference>::type Value;
+        typedef std::is_base_of<Figure, Value> IsFigure;
+        std::vector<typename std::conditional<IsFigure::value, const Value*, Value>::type> result;
+        for (auto it = derived().begin(), end = derived().end(); it != end; ++it) {
+            result.push_back(element(*it, IsFigure()));
+        }
+        return result;
+    }
+
+private:
+    const Derived& derived() const { return static_cast<const Derived&>(*this); }
+
+    template <typename Value>
+    static const Value* element(const Value& value, std::true_type) { return &value; }
+    template <typename Value>
+    static Value element(Value value, std::false_type) { return value; }
+};
+
+// Корень цепочки: любая коллекция, элементы которой - фигуры или указатели на них.
+template <typename Range>
+class RangeView : public ViewBase<RangeView<Range>> {
+private:
+    const Range* range;
+
+    static const Figure& figure(const Figure& fig) { return fig; }
+    // Иначе шаблон точнее подходит и для самих фигур (Trapezoid, не Figure).
+    template <typename Pointer,
+              typename = typename std::enable_if<!std::is_base_of<Figure, Pointer>::value>::type>
+    static const Figure& figure(const Pointer& fig) { return *fig; }
+
+public:
+    typedef const Figure& reference;
+
+    class iterator {
+    private:
+        typename Range::const_iterator it;
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Figure value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const Figure* pointer;
+        typedef const Figure& reference;
+
+        explicit iterator(typename Range::const_iterator it) : it(it) {}
+        const Figure& operator*() const { return figure(*it); }
+        iterator& operator++() { ++it; return *this; }
+        bool operator==(const iterator& other) const { return it == other.it; }
+        bool operator!=(const iterator& other) const { return it != other.it; }
+    };
+
+    explicit RangeView(const Range& range) : range(&range) {}
+    iterator begin() const { return iterator(range->begin()); }
+    iterator end() const { return iterator(range->end()); }
+};
+
+// Фигуры массива по списку индексов (например, из CompiledQuery::select).
+class IndexView : public ViewBase<IndexView> {
+private:
+    const FigureArray* figures;
+    std::vector<size_t> indices;
+
+public:
+    typedef const Figure& reference;
+
+    class iterator {
+    private:
+        const FigureArray* figures;
+        std::vector<size_t>::const_iterator it;
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Figure value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const Figure* pointer;
+        typedef const Figure& reference;
+
+        iterator(const FigureArray* figures, std::vector<size_t>::const_iterator it) : figures(figures), it(it) {}
+        const Figure& operator*() const { return *figures->at(*it); }
+        iterator& operator++() { ++it; return *this; }
+        bool operator==(const iterator& other) const { return it == other.it; }
+        bool operator!=(const iterator& other) const { return it != other.it; }
+    };
+
+    IndexView(const FigureArray& figures, std::vector<size_t> indices)
+        : figures(&figures), indices(std::move(indices)) {}
+    iterator begin() const { return iterator(figures, indices.begin()); }
+    iterator end() const { return iterator(figures, indices.end()); }
+};
+
+template <typename Base, typename Predicate>
+class FilterView : public ViewBase<FilterView<Base, Predicate>> {
+private:
+    Base base;
+    Predicate predicate;
+
+public:
+    typedef typename Base::reference reference;
+
+    class iterator {
+    private:
+        const FilterView* view;
+        typename Base::iterator it;
+        typename Base::iterator end;
+
+        void skip() {
+            while (it != end && !view->predicate(*it)) {
+                ++it;
+            }
+        }
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef typename Base::reference reference;
+        typedef typename std::decay<reference>::type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const value_type* pointer;
+
+        iterator(const FilterView* view, typename Base::iterator it, typename Base::iterator end)
+            : view(view), it(it), end(end) {
+            skip();
+        }
+        reference operator*() const { return *it; }
+        iterator& operator++() { ++it; skip(); return *this; }
+        bool operator==(const iterator& other) const { return it == other.it; }
+        bool operator!=(const iterator& other) const { return it != other.it; }
+    };
+
+    FilterView(const Base& base, Predicate predicate) : base(base), predicate(std::move(predicate)) {}
+    iterator begin() const { return iterator(this, base.begin(), base.end()); }
+    iterator end() const { return iterator(this, base.end(), base.end()); }
+};
+
+template <typename Base, typename Function>
+class TransformView : public ViewBase<TransformView<Base, Function>> {
+private:
+    Base base;
+    Function function;
+
+public:
+    // Значение, а не ссылка: результат вычисляется при каждом разыменовании.
+    typedef typename std::result_of<const Function&(typename Base::reference)>::type reference;
+
+    class iterator {
+    private:
+        const TransformView* view;
+        typename Base::iterator it;
+
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef typename TransformView::reference reference;
+        typedef typename std::decay<reference>::type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const value_type* pointer;
+
+        iterator(const TransformView* view, typename Base::iterator it) : view(view), it(it) {}
+        reference operator*() const { return view->function(*it); }
+        iterator& operator++() { ++it; return *this; }
+        bool operator==(const iterator& other) const { return it == other.it; }
+        bool operator!=(const iterator& other) const { return it != other.it; }
+    };
+
+    TransformView(const Base& base, Function function) : base(base), function(std::move(function)) {}
+    iterator begin() const { return iterator(this, base.begin()); }
+    iterator end() const { return iterator(this, base.end()); }
+};
+
+template <typename Base>
+class TakeView : public ViewBase<TakeView<Base>> {
+private:
+    Base base;
+    size_t limit;
+
+public:
+    typedef typename Base::reference reference;
+
+    // Конец - исчерпание лимита или исходного представления; следующий
+    // элемент после последнего взятого не вычисляется.
+    class iterator {
+    private:
+        typename Base::iterator it;
+        typename Base::iterator end;
+        size_t left;
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef typename Base::reference reference;
+        typedef typename std::decay<reference>::type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const value_type* pointer;
+
+        iterator(typename Base::iterator it, typename Base::iterator end, size_t left)
+            : it(it), end(end), left(it == end ? 0 : left) {}
+        reference operator*() const { return *it; }
+        iterator& operator++() {
+            if (--left != 0) {
+                ++it;
+                if (it == end) {
+                    left = 0;
+                }
+            }
+            return *this;
+        }
+        bool operator==(const iterator& other) const { return left == other.left && (left == 0 || it == other.it); }
+        bool operator!=(const iterator& other) const { return !(*this == other); }
+    };
+
+    TakeView(const Base& base, size_t limit) : base(base), limit(limit) {}
+    iterator begin() const { return iterator(base.begin(), base.end(), limit); }
+    iterator end() const { return iterator(base.end(), base.end(), 0); }
+};
+
+template <typename Base, typename T>
+class TypeView : public ViewBase<TypeView<Base, T>> {
+private:
+    Base base;
+
+public:
+    typedef const T& reference;
+
+    class iterator {
+    private:
+        typename Base::iterator it;
+        typename Base::iterator end;
+
+        void skip() {
+            while (it != end && typeid(*it) != typeid(T)) {
+                ++it;
+            }
+        }
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const T* pointer;
+        typedef const T& reference;
+
+        iterator(typename Base::iterator it, typename Base::iterator end) : it(it), end(end) { skip(); }
+        const T& operator*() const { return static_cast<const T&>(*it); }
+        iterator& operator++() { ++it; skip(); return *this; }
+        bool operator==(const iterator& other) const { return it == other.it; }
+        bool operator!=(const iterator& other) const { return it != other.it; }
+    };
+
+    explicit TypeView(const Base& base) : base(base) {}
+    iterator begin() const { return iterator(base.begin(), base.end()); }
+    iterator end() const { return iterator(base.end(), base.end()); }
+};
+
+template <typename Derived>
+template <typename Predicate>
+FilterView<Derived, Predicate> ViewBase<Derived>::filter(Predicate predicate) const {
+    return FilterView<Derived, Predicate>(derived(), std::move(predicate));
+}
+
+template <typename Derived>
+template <typename Function>
+TransformView<Derived, Function> ViewBase<Derived>::transform(Function function) const {
+    return TransformView<Derived, Function>(derived(), std::move(function));
+}
+
+template <typename Derived>
+TakeView<Derived> ViewBase<Derived>::take(size_t count) const {
+    return TakeView<Derived>(derived(), count);
+}
+
+template <typename Derived>
+template <typename T>
+TypeView<Derived, T> ViewBase<Derived>::byType() const {
+    static_assert(std::is_base_of<Figure, typename std::decay<typename Derived::reference>::type>::value,
+                  "byType applies to views of figures");
+    return TypeView<Derived, T>(derived());
+}
+
+namespace Views {
+    template <typename Range>
+    RangeView<Range> all(const Range& range) {
+        return RangeView<Range>(range);
+    }
+
+    inline IndexView select(const FigureArray& figures, std::vector<size_t> indices) {
+        return IndexView(figures, std::move(indices));
+    }
+}
+
+#endif
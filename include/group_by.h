@@ -0,0 +1,69 @@
+#ifndef GROUP_BY_H
+#define GROUP_BY_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "figure.h"
+#include "figure_array.h"
+
+// Набор вычисляемых агрегатов (битовая маска).
+namespace Aggregate {
+    const unsigned COUNT = 1;
+    const unsigned AREA = 2;      // сумма, среднее, минимум и максимум площади
+    const unsigned PERIMETER = 4; // сумма и среднее периметра
+    const unsigned EXTENT = 8;    // общая рамка группы
+    const unsigned ALL = COUNT | AREA | PERIMETER | EXTENT;
+}
+
+// Пользовательская метка фигуры - второй ключ группировки.
+typedef std::function<int(size_t index, const Figure& fig)> FigureTagger;
+
+struct GroupKey {
+    std::string type;
+    int tag = 0;
+    bool operator<(const GroupKey& other) const;
+    bool operator==(const GroupKey& other) const { return type == other.type && tag == other.tag; }
+};
+
+struct GroupStats {
+    size_t count = 0;
+    double totalArea = 0;
+    double minArea;
+    double maxArea;
+    double totalPerimeter = 0;
+    BoundingBox extent;
+
+    GroupStats();
+    double meanArea() const { return count ? totalArea / count : 0; }
+    double meanPerimeter() const { return count ? totalPerimeter / count : 0; }
+    void merge(const GroupStats& other);
+};
+
+// Итоговая таблица, строки упорядочены по (тип, метка).
+class GroupByResult {
+public:
+    typedef std::pair<GroupKey, GroupStats> Row;
+
+private:
+    std::vector<Row> rows;
+
+public:
+    explicit GroupByResult(std::vector<Row> rows) : rows(std::move(rows)) {}
+    size_t size() const { return rows.size(); }
+    const Row& operator[](size_t index) const { return rows[index]; }
+    // nullptr, если такой группы нет.
+    const GroupStats* find(const std::string& type, int tag = 0) const;
+    std::vector<Row>::const_iterator begin() const { return rows.begin(); }
+    std::vector<Row>::const_iterator end() const { return rows.end(); }
+};
+
+namespace GroupBy {
+    // Один параллельный проход: таблица групп на поток, слияние в конце.
+    GroupByResult byType(const FigureArray& figures, unsigned aggregates = Aggregate::ALL,
+                         const FigureTagger& tagger = FigureTagger());
+}
+
+#endif
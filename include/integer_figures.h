@@ -0,0 +1,174 @@
+#ifndef INTEGER_FIGURES_H
+#define INTEGER_FIGURES_H
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "figure.h"
+
+// Фигуры на целочисленной сетке: все проверки точные, без EPSILON.
+// Промежуточные значения считаются в 128 битах (расширение GCC/Clang).
+
+template <typename T>
+struct IntPoint {
+    T x, y;
+    IntPoint(T x = 0, T y = 0) : x(x), y(y) {}
+    bool operator==(const IntPoint& other) const { return x == other.x && y == other.y; }
+    bool operator!=(const IntPoint& other) const { return !(*this == other); }
+    Point toPoint() const { return Point(static_cast<double>(x), static_cast<double>(y)); }
+};
+
+namespace IntegerGeometry {
+    typedef __int128 Wide;
+
+    // Допустимый модуль координаты: разности должны помещаться в int64,
+    // а суммы произведений разностей - в Wide.
+    template <typename T> struct CoordinateLimits;
+    template <> struct CoordinateLimits<int32_t> {
+        static constexpr int64_t MAX_ABS = INT32_MAX;
+    };
+    template <> struct CoordinateLimits<int64_t> {
+        static constexpr int64_t MAX_ABS = int64_t(1) << 61;
+    };
+
+    template <typename T>
+    bool inRange(const IntPoint<T>& p) {
+        const int64_t limit = CoordinateLimits<T>::MAX_ABS;
+        return p.x >= -limit && p.x <= limit && p.y >= -limit && p.y <= limit;
+    }
+
+    // (b - a) x (c - a)
+    template <typename T>
+    Wide crossProduct(const IntPoint<T>& a, const IntPoint<T>& b, const IntPoint<T>& c) {
+        return Wide(int64_t(b.x) - a.x) * Wide(int64_t(c.y) - a.y) -
+               Wide(int64_t(b.y) - a.y) * Wide(int64_t(c.x) - a.x);
+    }
+
+    // (b - a) x (d - c)
+    template <typename T>
+    Wide crossProduct(const IntPoint<T>& a, const IntPoint<T>& b, const IntPoint<T>& c, const IntPoint<T>& d) {
+        return Wide(int64_t(b.x) - a.x) * Wide(int64_t(d.y) - c.y) -
+               Wide(int64_t(b.y) - a.y) * Wide(int64_t(d.x) - c.x);
+    }
+
+    // (b - a) . (d - c)
+    template <typename T>
+    Wide dotProduct(const IntPoint<T>& a, const IntPoint<T>& b, const IntPoint<T>& c, const IntPoint<T>& d) {
+        return Wide(int64_t(b.x) - a.x) * Wide(int64_t(d.x) - c.x) +
+               Wide(int64_t(b.y) - a.y) * Wide(int64_t(d.y) - c.y);
+    }
+
+    template <typename T>
+    Wide squaredDistance(const IntPoint<T>& a, const IntPoint<T>& b) {
+        return dotProduct(a, b, a, b);
+    }
+
+    template <typename T>
+    bool areParallel(const IntPoint<T>& a, const IntPoint<T>& b, const IntPoint<T>& c, const IntPoint<T>& d) {
+        return a != b && c != d && crossProduct(a, b, c, d) == 0;
+    }
+
+    template <typename T>
+    bool areCollinear(const IntPoint<T>& a, const IntPoint<T>& b, const IntPoint<T>& c) {
+        return crossProduct(a, b, c) == 0;
+    }
+
+    std::string toString(Wide value);
+}
+
+// Общая часть целочисленных фигур; Derived предоставляет validate().
+template <typename Derived, typename T, size_t N>
+class IntPolygon {
+protected:
+    static const size_t VERTEX_COUNT = N;
+    IntPoint<T> vertices[N];
+    bool validState = false;
+
+    void checkRange() const;
+    void validateState() const;
+    const char* name() const { return Derived::NAME; }
+
+public:
+    typedef T Coordinate;
+
+    size_t vertexCount() const { return N; }
+    IntPoint<T> getVertex(size_t index) const;
+    void setVertex(size_t index, const IntPoint<T>& p);
+    void clearVertices();
+    // Удвоенная площадь - всегда целое число.
+    IntegerGeometry::Wide twiceArea() const;
+    double area() const;
+    Point geometricCenter() const;
+    void print(std::ostream& os) const;
+    void read(std::istream& is);
+    bool operator==(const Derived& other) const;
+    bool operator!=(const Derived& other) const { return !(*this == other); }
+};
+
+template <typename T>
+class IntTrapezoid : public IntPolygon<IntTrapezoid<T>, T, 4> {
+public:
+    static const char* const NAME;
+    IntTrapezoid() = default;
+    IntTrapezoid(const IntPoint<T>& p1, const IntPoint<T>& p2, const IntPoint<T>& p3, const IntPoint<T>& p4);
+    void validate() const;
+    std::shared_ptr<Figure> toFigure() const;
+};
+
+template <typename T>
+class IntRhombus : public IntPolygon<IntRhombus<T>, T, 4> {
+public:
+    static const char* const NAME;
+    IntRhombus() = default;
+    IntRhombus(const IntPoint<T>& p1, const IntPoint<T>& p2, const IntPoint<T>& p3, const IntPoint<T>& p4);
+    void validate() const;
+    std::shared_ptr<Figure> toFigure() const;
+};
+
+template <typename T>
+class IntPentagon : public IntPolygon<IntPentagon<T>, T, 5> {
+public:
+    static const char* const NAME;
+    IntPentagon() = default;
+    IntPentagon(const IntPoint<T>& p1, const IntPoint<T>& p2, const IntPoint<T>& p3,
+                const IntPoint<T>& p4, const IntPoint<T>& p5);
+    void validate() const;
+    std::shared_ptr<Figure> toFigure() const;
+};
+
+template <typename Derived, typename T, size_t N>
+std::ostream& operator<<(std::ostream& os, const IntPolygon<Derived, T, N>& fig) {
+    fig.print(os);
+    return os;
+}
+
+template <typename Derived, typename T, size_t N>
+std::istream& operator>>(std::istream& is, IntPolygon<Derived, T, N>& fig) {
+    fig.read(is);
+    return is;
+}
+
+typedef IntPoint<int32_t> IntPoint32;
+typedef IntPoint<int64_t> IntPoint64;
+typedef IntTrapezoid<int32_t> IntTrapezoid32;
+typedef IntTrapezoid<int64_t> IntTrapezoid64;
+typedef IntRhombus<int32_t> IntRhombus32;
+typedef IntRhombus<int64_t> IntRhombus64;
+typedef IntPentagon<int32_t> IntPentagon32;
+typedef IntPentagon<int64_t> IntPentagon64;
+
+extern template class IntPolygon<IntTrapezoid<int32_t>, int32_t, 4>;
+extern template class IntPolygon<IntTrapezoid<int64_t>, int64_t, 4>;
+extern template class IntPolygon<IntRhombus<int32_t>, int32_t, 4>;
+extern template class IntPolygon<IntRhombus<int64_t>, int64_t, 4>;
+extern template class IntPolygon<IntPentagon<int32_t>, int32_t, 5>;
+extern template class IntPolygon<IntPentagon<int64_t>, int64_t, 5>;
+extern template class IntTrapezoid<int32_t>;
+extern template class IntTrapezoid<int64_t>;
+extern template class IntRhombus<int32_t>;
+extern template class IntRhombus<int64_t>;
+extern template class IntPentagon<int32_t>;
+extern template class IntPentagon<int64_t>;
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef KD_TREE_H
+#define KD_TREE_H
+
+#include <cstddef>
+#include <vector>
+#include "convex_polygon.h"
+#include "figure_array.h"
+
+struct FigureNeighbor {
+    size_t index;
+    double distance;
+};
+
+// KD-дерево по центрам фигур; узел хранит общую рамку своих фигур, поэтому
+// расстояние до рамки - нижняя граница для всего поддерева. Дерево строится
+// по снимку вершин и не отслеживает последующие изменения массива.
+class FigureKdTree {
+private:
+    static const size_t LEAF_SIZE = 8;
+    static const size_t NONE = static_cast<size_t>(-1);
+
+    struct Node {
+        BoundingBox box;
+        size_t begin, end;
+        size_t left = NONE, right = NONE;
+    };
+
+    std::vector<ConvexPolygon> polygons;
+    std::vector<BoundingBox> boxes;
+    std::vector<Point> centers;
+    std::vector<size_t> order;
+    std::vector<Node> nodes;
+
+    size_t build(size_t begin, size_t end);
+    void search(size_t node, const Point& p, size_t k, std::vector<FigureNeighbor>& heap) const;
+
+public:
+    explicit FigureKdTree(const FigureArray& figures);
+    explicit FigureKdTree(std::vector<ConvexPolygon> polygons);
+
+    size_t size() const { return polygons.size(); }
+    // k ближайших фигур по точному расстоянию до многоугольника, по возрастанию.
+    std::vector<FigureNeighbor> nearest(const Point& p, size_t k) const;
+    std::vector<std::vector<FigureNeighbor>> nearestBatch(const std::vector<Point>& points, size_t k) const;
+};
+
+#endif
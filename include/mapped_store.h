@@ -0,0 +1,77 @@
+#ifndef MAPPED_STORE_H
+#define MAPPED_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "figure.h"
+#include "figure_array.h"
+#include "figure_record.h"
+
+// Коллекция фигур в отображённом в память файле. Файл - заголовок на одну
+// страницу и массив FigureRecord, то есть ровно то, что лежит в памяти:
+// открытие не читает данные, страницы подгружаются ядром при обращении.
+// Добавленные записи становятся долговечными после sync(); при открытии
+// видны только записи, зафиксированные последним sync() или close().
+class MappedFigureStore {
+public:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t recordSize;
+        uint64_t count;    // зафиксированных записей
+        uint64_t capacity; // записей, под которые выделен файл
+        uint64_t sequence; // задаётся владельцем, например номер последней учтённой записи журнала
+    };
+
+private:
+    std::string path;
+    int fd = -1;
+    unsigned char* base = nullptr;
+    size_t mappedBytes = 0;
+    size_t count = 0;
+    size_t syncedCount = 0;
+
+    MappedFigureStore(const std::string& path, int fd);
+    Header& header() const { return *reinterpret_cast<Header*>(base); }
+    FigureRecord* records() const;
+    void map(size_t capacity);
+    void unmap();
+
+public:
+    static const uint32_t VERSION = 2;
+    static const size_t HEADER_SIZE = 4096;
+
+    // Новый пустой файл (существующий перезаписывается).
+    static MappedFigureStore create(const std::string& path, size_t capacity = 1024);
+    // Ошибки ввода-вывода и чужой формат - std::runtime_error.
+    static MappedFigureStore open(const std::string& path);
+
+    MappedFigureStore(MappedFigureStore&& other) noexcept;
+    MappedFigureStore& operator=(MappedFigureStore&& other) noexcept;
+    MappedFigureStore(const MappedFigureStore&) = delete;
+    MappedFigureStore& operator=(const MappedFigureStore&) = delete;
+    // Вызывает close(); долговечность не гарантируется.
+    ~MappedFigureStore();
+
+    size_t size() const { return count; }
+    size_t capacity() const;
+    const FigureRecord& record(size_t index) const;
+    const FigureRecord* begin() const { return records(); }
+    const FigureRecord* end() const { return records() + count; }
+    // Создаёт фигуру из записи.
+    std::shared_ptr<Figure> figure(size_t index) const;
+    uint64_t sequence() const { return base ? header().sequence : 0; }
+    // Сохраняется вместе со счётчиком при следующем sync().
+    void setSequence(uint64_t value) { header().sequence = value; }
+
+    void append(const Figure& fig);
+    void append(const FigureArray& figures);
+    // Точка долговечности: записи сбрасываются на диск раньше счётчика в заголовке.
+    void sync();
+    // Фиксирует счётчик без ожидания диска и закрывает файл.
+    void close();
+};
+
+#endif
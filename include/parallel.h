@@ -0,0 +1,67 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace Parallel {
+    inline size_t threadCount() {
+        unsigned hw = std::thread::hardware_concurrency();
+        return hw == 0 ? 1 : hw;
+    }
+
+    // Сколько потоков получит диапазон из count элементов при блоке не меньше minBlock.
+    inline size_t workerCount(size_t count, size_t minBlock) {
+        if (minBlock == 0) {
+            minBlock = 1;
+        }
+        size_t byWork = (count + minBlock - 1) / minBlock;
+        return std::max<size_t>(1, std::min(threadCount(), byWork));
+    }
+
+    // Делит [0, count) на непрерывные блоки и вызывает body(worker, begin, end)
+    // для каждого; блок 0 выполняется в вызывающем потоке. Исключение из
+    // любого блока пробрасывается после завершения всех потоков.
+    template <typename Body>
+    size_t forBlocks(size_t count, size_t minBlock, Body body) {
+        size_t workers = workerCount(count, minBlock);
+        if (workers == 1) {
+            body(size_t(0), size_t(0), count);
+            return 1;
+        }
+        std::vector<std::exception_ptr> errors(workers);
+        std::vector<std::thread> threads;
+        threads.reserve(workers - 1);
+        size_t step = (count + workers - 1) / workers;
+        for (size_t w = 1; w < workers; ++w) {
+            size_t begin = std::min(count, w * step);
+            size_t end = std::min(count, begin + step);
+            threads.emplace_back([&body, &errors, w, begin, end]() {
+                try {
+                    body(w, begin, end);
+                } catch (...) {
+                    errors[w] = std::current_exception();
+                }
+            });
+        }
+        try {
+            body(size_t(0), size_t(0), std::min(count, step));
+        } catch (...) {
+            errors[0] = std::current_exception();
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        for (const auto& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+        return workers;
+    }
+}
+
+#endif
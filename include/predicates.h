@@ -0,0 +1,18 @@
+#ifndef PREDICATES_H
+#define PREDICATES_H
+
+#include "figure.h"
+
+// Адаптивные геометрические предикаты (по Shewchuk): быстрый фильтр с
+// вычисленной оценкой погрешности, точная арифметика разложений - только
+// когда фильтр не может определить знак.
+namespace Predicates {
+    // (b - a) x (c - a); знак результата всегда верный.
+    double orient2d(const Point& a, const Point& b, const Point& c);
+    // (b - a) x (d - c); знак результата всегда верный.
+    double cross2d(const Point& a, const Point& b, const Point& c, const Point& d);
+    // 1 - левый поворот, -1 - правый, 0 - точки на одной прямой.
+    int orientation(const Point& a, const Point& b, const Point& c);
+}
+
+#endif
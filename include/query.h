@@ -0,0 +1,115 @@
+#ifndef QUERY_H
+#define QUERY_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "figure.h"
+#include "figure_array.h"
+#include "figure_order.h"
+
+enum class Compare { Less, LessEqual, Greater, GreaterEqual, Equal, NotEqual };
+
+class CompiledQuery;
+
+// Необходимые условия, извлечённые из конъюнкции верхнего уровня запроса:
+// всякая подходящая фигура им удовлетворяет (обратное не обязательно).
+struct QueryConstraints {
+    std::string type;  // пусто - любой тип
+    double minArea;    // границы включительно
+    double maxArea;
+    bool hasWindow = false;
+    BoundingBox window; // рамка фигуры пересекает window
+
+    QueryConstraints();
+};
+
+// Дерево условия над фигурой. Строится DSL-ом или из строки, например
+//   type == Rhombus && area > 10 && bbox intersects [0, 0, 100, 100]
+// Поля: area, perimeter, x, y (центр); bbox intersects|within [minX, minY, maxX, maxY];
+// связки &&, ||, ! и скобки.
+class Query {
+public:
+    struct Node;
+
+private:
+    std::shared_ptr<const Node> root;
+
+    explicit Query(std::shared_ptr<const Node> root) : root(std::move(root)) {}
+
+public:
+    // Истинно для любой фигуры.
+    Query();
+
+    static Query type(const std::string& name);
+    static Query compare(FigureKey key, Compare op, double value);
+    static Query bboxIntersects(const BoundingBox& box);
+    static Query bboxWithin(const BoundingBox& box);
+    // Некорректный текст - std::invalid_argument с позицией ошибки.
+    static Query parse(const std::string& text);
+
+    Query operator&&(const Query& other) const;
+    Query operator||(const Query& other) const;
+    Query operator!() const;
+
+    CompiledQuery compile() const;
+    QueryConstraints constraints() const;
+};
+
+// Числовое поле в DSL: Q::area() > 10.
+class QueryField {
+private:
+    FigureKey key;
+
+public:
+    explicit QueryField(FigureKey key) : key(key) {}
+    Query operator<(double value) const { return Query::compare(key, Compare::Less, value); }
+    Query operator<=(double value) const { return Query::compare(key, Compare::LessEqual, value); }
+    Query operator>(double value) const { return Query::compare(key, Compare::Greater, value); }
+    Query operator>=(double value) const { return Query::compare(key, Compare::GreaterEqual, value); }
+    Query operator==(double value) const { return Query::compare(key, Compare::Equal, value); }
+    Query operator!=(double value) const { return Query::compare(key, Compare::NotEqual, value); }
+};
+
+namespace Q {
+    inline QueryField area() { return QueryField(FigureKey::Area); }
+    inline QueryField perimeter() { return QueryField(FigureKey::Perimeter); }
+    inline QueryField x() { return QueryField(FigureKey::CenterX); }
+    inline QueryField y() { return QueryField(FigureKey::CenterY); }
+    inline Query type(const std::string& name) { return Query::type(name); }
+    inline Query bboxIntersects(const BoundingBox& box) { return Query::bboxIntersects(box); }
+    inline Query bboxWithin(const BoundingBox& box) { return Query::bboxWithin(box); }
+}
+
+// Условие, скомпилированное в плоскую программу с переходами для
+// сокращённого вычисления && и ||. Каждая характеристика фигуры вычисляется
+// не более одного раза и только если до неё дошло выполнение.
+class CompiledQuery {
+public:
+    enum class Op { True, TypeEquals, Compare, BoxIntersects, BoxWithin, Not, JumpIfFalse, JumpIfTrue };
+
+    struct Instruction {
+        Op op;
+        FigureKey key;
+        Compare compare;
+        double value;
+        BoundingBox box;
+        std::string typeName;
+        size_t target; // для переходов
+    };
+
+private:
+    std::vector<Instruction> program;
+
+    friend class Query;
+
+public:
+    bool matches(const Figure& fig) const;
+    // Индексы подходящих фигур по возрастанию; проверка идёт параллельно.
+    std::vector<size_t> select(const FigureArray& figures) const;
+    size_t count(const FigureArray& figures) const;
+    size_t size() const { return program.size(); }
+};
+
+#endif
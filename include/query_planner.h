@@ -0,0 +1,73 @@
+#ifndef QUERY_PLANNER_H
+#define QUERY_PLANNER_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+#include "figure.h"
+#include "figure_array.h"
+#include "query.h"
+
+// FullScan - запрос к каждой фигуре; ColumnScan - сначала последовательный
+// просмотр хранимых столбцов (тип, площадь, рамка), затем запрос к прошедшим;
+// индексные пути перебирают только кандидатов индекса.
+enum class AccessPath { FullScan, ColumnScan, TypeIndex, AreaIndex, SpatialIndex };
+
+struct QueryPlan {
+    AccessPath path = AccessPath::FullScan;
+    // Сколько строк перебирается и сколько из них дойдёт до полной проверки.
+    double estimatedCandidates = 0;
+    double estimatedMatches = 0;
+    double estimatedCost = 0;
+
+    std::string describe() const;
+};
+
+// Индексы и статистика по снимку массива: столбцы типа, площади и рамки,
+// список фигур каждого типа, фигуры, упорядоченные по площади, и равномерная
+// сетка по центрам рамок. Для запроса оценивает избирательность каждого
+// условия (условия считаются независимыми) и выбирает самый дешёвый путь.
+// Кандидаты любого пути сначала отсеиваются по столбцам остальных условий,
+// затем проверяются полным запросом.
+// Действителен, пока массив не изменился; после изменений - rebuild().
+class QueryPlanner {
+private:
+    struct Grid {
+        BoundingBox extent;
+        size_t columns = 0, rows = 0;
+        double cellWidth = 0, cellHeight = 0;
+        // Наибольшие полуразмеры рамок: насколько окно расширяется при поиске по центрам.
+        double halfWidth = 0, halfHeight = 0;
+        std::vector<size_t> cellStart; // CSR: фигуры ячейки c - items[cellStart[c], cellStart[c + 1])
+        std::vector<size_t> items;
+        std::vector<size_t> prefix;    // (rows + 1) x (columns + 1), суммы числа фигур
+
+        bool cellRange(const BoundingBox& window, size_t& c0, size_t& r0, size_t& c1, size_t& r1) const;
+    };
+
+    const FigureArray* figures;
+    std::vector<const char*> types;
+    std::vector<double> areas;
+    std::vector<BoundingBox> boxes;
+    std::map<std::string, std::vector<size_t>> byType;
+    std::vector<double> sortedAreas;
+    std::vector<size_t> areaOrder;
+    Grid grid;
+
+    size_t areaRange(double low, double high, size_t& first, size_t& last) const;
+    size_t spatialCount(const BoundingBox& window) const;
+    std::vector<size_t> candidates(AccessPath path, const QueryConstraints& constraints) const;
+    bool passesColumns(size_t index, const QueryConstraints& constraints) const;
+
+public:
+    explicit QueryPlanner(const FigureArray& figures);
+    void rebuild();
+
+    QueryPlan plan(const Query& query) const;
+    // Индексы подходящих фигур по возрастанию, как CompiledQuery::select.
+    std::vector<size_t> execute(const Query& query) const;
+    std::vector<size_t> execute(const Query& query, const QueryPlan& plan) const;
+};
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef SHARDED_COLLECTION_H
+#define SHARDED_COLLECTION_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "figure.h"
+#include "figure_array.h"
+#include "query.h"
+
+enum class ShardKey {
+    HASH,    // по идентификатору - равномерно, правки фигуру не переносят
+    SPATIAL  // по ячейке сетки cellSize x cellSize центра рамки - соседние фигуры в одном сегменте
+};
+
+// Коллекция фигур, разбитая на сегменты со своей блокировкой и хранилищем.
+// Изменение блокирует только сегмент фигуры (и запись о ней в каталоге,
+// тоже разбитом на части), поэтому записи в разные сегменты идут
+// параллельно. Фигуры адресуются постоянными идентификаторами. При SPATIAL
+// фигура, центр рамки которой после setVertex ушёл в ячейку другого
+// сегмента, переносится туда под блокировкой обоих сегментов; остальные
+// правки касаются одного сегмента.
+//
+// Запрос блокирует все сегменты по возрастанию номера, отпускает те, рамка
+// содержимого которых не задевает окно запроса (Query::constraints; при
+// SPATIAL таких большинство), и держит остальные до конца параллельного
+// обхода. Результат соответствует одному моменту: переезжающая фигура не
+// пропускается и не учитывается дважды, а записи в обходимые сегменты на
+// время запроса ждут.
+class ShardedFigureCollection {
+private:
+    struct Shard {
+        mutable std::mutex mutex;
+        FigureArray figures;
+        std::vector<uint64_t> ids;                   // ids[i] - фигура figures.at(i)
+        std::unordered_map<uint64_t, size_t> positions;
+        BoundingBox bounds; // охватывает все фигуры; при удалении не сжимается
+    };
+
+    // Где лежит фигура: часть каталога выбирается по id.
+    struct Directory {
+        std::mutex mutex;
+        std::unordered_map<uint64_t, size_t> shard;
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::vector<std::unique_ptr<Directory>> directory;
+    std::atomic<uint64_t> nextId{0};
+    ShardKey key;
+    double cellSize;
+
+    size_t shardFor(uint64_t id, const Figure& fig) const;
+    static bool relevant(const Shard& shard, const QueryConstraints* constraints);
+    Directory& directoryFor(uint64_t id) const { return *directory[id % directory.size()]; }
+    static void insert(Shard& shard, uint64_t id, std::shared_ptr<const Figure> fig);
+    static std::shared_ptr<const Figure> extract(Shard& shard, uint64_t id);
+    template <typename Visit>
+    void scan(const QueryConstraints* constraints, Visit visit) const;
+
+public:
+    // shardCount == 0 - по числу аппаратных потоков.
+    explicit ShardedFigureCollection(size_t shardCount = 0, ShardKey key = ShardKey::HASH, double cellSize = 100);
+
+    uint64_t addFigure(std::shared_ptr<const Figure> fig);
+    // false, если такой фигуры нет.
+    bool removeFigure(uint64_t id);
+    // Неизвестный id - std::out_of_range.
+    void setVertex(uint64_t id, size_t vertex, const Point& p);
+    std::shared_ptr<const Figure> find(uint64_t id) const;
+
+    size_t shardCount() const { return shards.size(); }
+    // Сегмент, где сейчас лежит фигура; неизвестный id - std::out_of_range.
+    size_t shardOf(uint64_t id) const;
+    size_t shardSize(size_t shard) const;
+    size_t size() const;
+
+    // Сегменты, которые пришлось бы обойти для запроса сейчас.
+    std::vector<size_t> candidateShards(const Query& query) const;
+    // Идентификаторы подходящих фигур по возрастанию.
+    std::vector<uint64_t> select(const Query& query) const;
+    size_t count(const Query& query) const;
+    double totalArea() const;
+    // Все фигуры одним массивом, сегмент за сегментом.
+    FigureArray snapshot() const;
+};
+
+#endif
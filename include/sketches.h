@@ -0,0 +1,111 @@
+#ifndef SKETCHES_H
+#define SKETCHES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "figure.h"
+#include "figure_array.h"
+#include "figure_reader.h"
+
+// Объединяемый t-digest: приближённые квантили за O(compression) памяти.
+// Точность выше всего у хвостов распределения (p1, p99).
+class TDigest {
+private:
+    struct Centroid {
+        double mean;
+        double weight;
+    };
+
+    double compression;
+    std::vector<Centroid> centroids; // по возрастанию mean
+    std::vector<Centroid> buffer;    // ещё не сжатые значения
+    double totalWeight = 0;
+    double minValue = 0, maxValue = 0;
+
+    std::vector<Centroid> compressed(std::vector<Centroid> points) const;
+    void flush();
+
+public:
+    explicit TDigest(double compression = 100);
+
+    void add(double value, double weight = 1);
+    void merge(const TDigest& other);
+    double quantile(double q) const;
+    double count() const { return totalWeight; }
+    double min() const { return minValue; }
+    double max() const { return maxValue; }
+    size_t centroidCount() const;
+};
+
+// Гистограмма с равными корзинами на [low, high) и счётчиками выхода за границы.
+class FixedHistogram {
+private:
+    double low, high;
+    std::vector<uint64_t> buckets;
+    uint64_t underflow = 0, overflow = 0;
+
+public:
+    FixedHistogram(double low, double high, size_t bucketCount);
+
+    void add(double value);
+    // Гистограммы должны иметь одинаковую разметку.
+    void merge(const FixedHistogram& other);
+    size_t bucketCount() const { return buckets.size(); }
+    uint64_t count(size_t bucket) const { return buckets.at(bucket); }
+    double bucketLow(size_t bucket) const;
+    double bucketHigh(size_t bucket) const { return bucketLow(bucket + 1); }
+    uint64_t underflowCount() const { return underflow; }
+    uint64_t overflowCount() const { return overflow; }
+    uint64_t total() const;
+};
+
+struct HistogramLayout {
+    double low, high;
+    size_t buckets;
+};
+
+// Распределения площади и периметра: по всем фигурам и по каждому типу.
+// Считается по частям (поток, шард) и объединяется через merge().
+class FigureDistribution {
+public:
+    struct Metric {
+        TDigest digest;
+        FixedHistogram histogram;
+        Metric(const HistogramLayout& layout, double compression);
+        void add(double value);
+        void merge(const Metric& other);
+    };
+
+    struct Entry {
+        Metric area;
+        Metric perimeter;
+        Entry(const HistogramLayout& areaLayout, const HistogramLayout& perimeterLayout, double compression);
+        void merge(const Entry& other);
+    };
+
+private:
+    HistogramLayout areaLayout, perimeterLayout;
+    double compression;
+    Entry all;
+    std::map<std::string, Entry> byType;
+
+public:
+    FigureDistribution(const HistogramLayout& areaLayout, const HistogramLayout& perimeterLayout,
+                       double compression = 100);
+
+    void add(const Figure& fig);
+    void merge(const FigureDistribution& other);
+    const Entry& overall() const { return all; }
+    // nullptr, если фигур такого типа не было.
+    const Entry* forType(const std::string& typeName) const;
+
+    static FigureDistribution of(const FigureArray& figures, const HistogramLayout& areaLayout,
+                                 const HistogramLayout& perimeterLayout, double compression = 100);
+    static FigureDistribution of(FigureReader& reader, const HistogramLayout& areaLayout,
+                                 const HistogramLayout& perimeterLayout, double compression = 100);
+};
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef TOP_K_H
+#define TOP_K_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "figure.h"
+#include "figure_array.h"
+#include "figure_order.h"
+#include "figure_reader.h"
+
+typedef std::function<double(const Figure&)> FigureMetric;
+
+struct RankedFigure {
+    size_t index;
+    double value;
+    std::shared_ptr<const Figure> figure;
+};
+
+// Ограниченная куча из k лучших значений; при равенстве выигрывает меньший индекс.
+class TopKAccumulator {
+private:
+    size_t k;
+    bool largest;
+    std::vector<RankedFigure> heap;
+
+    bool better(const RankedFigure& a, const RankedFigure& b) const;
+
+public:
+    TopKAccumulator(size_t k, bool largest = true) : k(k), largest(largest) {}
+
+    // Попадёт ли значение в кучу при текущем её содержимом.
+    bool accepts(size_t index, double value) const;
+    void offer(size_t index, double value, std::shared_ptr<const Figure> figure = nullptr);
+    void merge(const TopKAccumulator& other);
+    // Лучшие первыми.
+    std::vector<RankedFigure> result() const;
+};
+
+namespace TopK {
+    // Один проход, параллельно: куча на поток, слияние в конце.
+    std::vector<RankedFigure> select(const FigureArray& figures, size_t k, const FigureMetric& metric,
+                                     bool largest = true);
+    std::vector<RankedFigure> select(const FigureArray& figures, size_t k, FigureKey key, bool largest = true);
+    // Потоковый вариант: хранятся только k фигур, индекс - номер записи в потоке.
+    std::vector<RankedFigure> select(FigureReader& reader, size_t k, const FigureMetric& metric,
+                                     bool largest = true);
+    std::vector<RankedFigure> select(FigureReader& reader, size_t k, FigureKey key, bool largest = true);
+}
+
+#endif
@@ -8,8 +8,13 @@ private:
     static const size_t VERTEX_COUNT = 4;
     Point vertices[VERTEX_COUNT];
     bool validState = false;
+    bool verified = false; // геометрия уже проверена и с тех пор не менялась
     void validate() const;
 
+protected:
+    CheckState checkState() const override;
+    void restoreCheckState(CheckState state) override;
+
 public:
     Trapezoid() = default;
     Trapezoid(const Point& p1, const Point& p2, const Point& p3, const Point& p4);
@@ -25,6 +30,9 @@ public:
     Point getVertex(size_t index) const override;
     void setVertex(size_t index, const Point& p) override;
     void clearVertices() override;
+    void transform(const AffineTransform& m) override;
+    bool transformMayFail(const AffineTransform& m) const override;
+    const char* typeName() const override { return "Trapezoid"; }
     Trapezoid& operator=(const Trapezoid& other);
     Trapezoid& operator=(Trapezoid&& other) noexcept;
 };
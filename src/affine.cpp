@@ -0,0 +1,57 @@
+#include "affine.h"
+#include <cmath>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static_assert(sizeof(Point) == 2 * sizeof(double), "Point must be two packed doubles");
+
+AffineTransform AffineTransform::identity() {
+    return AffineTransform();
+}
+
+AffineTransform AffineTransform::translation(double dx, double dy) {
+    return AffineTransform(1, 0, 0, 1, dx, dy);
+}
+
+AffineTransform AffineTransform::rotation(double angle, const Point& center) {
+    double cosA = std::cos(angle);
+    double sinA = std::sin(angle);
+    return AffineTransform(cosA, -sinA, sinA, cosA,
+                           center.x - cosA * center.x + sinA * center.y,
+                           center.y - sinA * center.x - cosA * center.y);
+}
+
+AffineTransform AffineTransform::scaling(double sx, double sy, const Point& center) {
+    return AffineTransform(sx, 0, 0, sy, center.x - sx * center.x, center.y - sy * center.y);
+}
+
+AffineTransform AffineTransform::then(const AffineTransform& next) const {
+    return AffineTransform(next.a * a + next.b * c, next.a * b + next.b * d,
+                           next.c * a + next.d * c, next.c * b + next.d * d,
+                           next.a * tx + next.b * ty + next.tx,
+                           next.c * tx + next.d * ty + next.ty);
+}
+
+namespace GeometryUtils {
+    void transformPoints(Point* points, size_t count, const AffineTransform& m) {
+#if defined(__SSE2__)
+        // одна точка - один регистр: [x', y'] = [a, c] * x + [b, d] * y + [tx, ty]
+        const __m128d col0 = _mm_set_pd(m.c, m.a);
+        const __m128d col1 = _mm_set_pd(m.d, m.b);
+        const __m128d shift = _mm_set_pd(m.ty, m.tx);
+        double* data = reinterpret_cast<double*>(points);
+        for (size_t i = 0; i < count; ++i) {
+            __m128d p = _mm_loadu_pd(data + 2 * i);
+            __m128d xx = _mm_unpacklo_pd(p, p);
+            __m128d yy = _mm_unpackhi_pd(p, p);
+            __m128d r = _mm_add_pd(_mm_add_pd(_mm_mul_pd(col0, xx), _mm_mul_pd(col1, yy)), shift);
+            _mm_storeu_pd(data + 2 * i, r);
+        }
+#else
+        for (size_t i = 0; i < count; ++i) {
+            points[i] = m.apply(points[i]);
+        }
+#endif
+    }
+}
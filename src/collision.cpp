@@ -0,0 +1,174 @@
+#include "collision.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+    const size_t SNAPSHOT_BLOCK = 4096;
+    const size_t NARROW_PHASE_BLOCK = 1024;
+    const size_t CLIP_CAPACITY = 2 * ConvexPolygon::MAX_VERTICES;
+
+    void project(const ConvexPolygon& poly, double axisX, double axisY, double& low, double& high) {
+        low = high = poly[0].x * axisX + poly[0].y * axisY;
+        for (size_t i = 1; i < poly.count; ++i) {
+            double value = poly[i].x * axisX + poly[i].y * axisY;
+            low = std::min(low, value);
+            high = std::max(high, value);
+        }
+    }
+
+    // Есть ли среди нормалей рёбер a разделяющая ось.
+    bool hasSeparatingAxis(const ConvexPolygon& a, const ConvexPolygon& b) {
+        for (size_t i = 0; i < a.count; ++i) {
+            const Point& p = a[i];
+            const Point& q = a[(i + 1) % a.count];
+            double axisX = p.y - q.y;
+            double axisY = q.x - p.x;
+            double lowA, highA, lowB, highB;
+            project(a, axisX, axisY, lowA, highA);
+            project(b, axisX, axisY, lowB, highB);
+            if (highA <= lowB || highB <= lowA) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    inline double side(const Point& a, const Point& b, const Point& p) {
+        return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+    }
+
+    // Оставляет часть многоугольника слева от прямой ab.
+    size_t clipByEdge(const Point* input, size_t count, const Point& a, const Point& b, Point* output) {
+        size_t result = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const Point& current = input[i];
+            const Point& next = input[(i + 1) % count];
+            double sideCurrent = side(a, b, current);
+            double sideNext = side(a, b, next);
+            if (sideCurrent >= 0) {
+                output[result++] = current;
+            }
+            if ((sideCurrent > 0 && sideNext < 0) || (sideCurrent < 0 && sideNext > 0)) {
+                double t = sideCurrent / (sideCurrent - sideNext);
+                output[result++] = Point(current.x + t * (next.x - current.x), current.y + t * (next.y - current.y));
+            }
+        }
+        return result;
+    }
+}
+
+namespace Collision {
+    bool overlaps(const ConvexPolygon& a, const ConvexPolygon& b) {
+        if (a.count < 3 || b.count < 3) {
+            return false;
+        }
+        return !hasSeparatingAxis(a, b) && !hasSeparatingAxis(b, a);
+    }
+
+    bool overlaps(const Figure& a, const Figure& b) {
+        return overlaps(ConvexPolygon::fromFigure(a), ConvexPolygon::fromFigure(b));
+    }
+
+    double intersectionArea(const ConvexPolygon& a, const ConvexPolygon& b) {
+        if (a.count < 3 || b.count < 3 || !a.bounds().intersects(b.bounds())) {
+            return 0;
+        }
+        Point buffers[2][CLIP_CAPACITY];
+        size_t count = a.count;
+        std::copy(a.vertices, a.vertices + a.count, buffers[0]);
+        int current = 0;
+        for (size_t i = 0; i < b.count && count > 0; ++i) {
+            count = clipByEdge(buffers[current], count, b[i], b[(i + 1) % b.count], buffers[1 - current]);
+            current = 1 - current;
+        }
+        double area = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const Point& p = buffers[current][i];
+            const Point& q = buffers[current][(i + 1) % count];
+            area += p.x * q.y - q.x * p.y;
+        }
+        return std::abs(area) / 2.0;
+    }
+
+    double intersectionArea(const Figure& a, const Figure& b) {
+        return intersectionArea(ConvexPolygon::fromFigure(a), ConvexPolygon::fromFigure(b));
+    }
+
+    std::vector<FigurePair> candidatePairs(const std::vector<BoundingBox>& boxes) {
+        std::vector<size_t> order(boxes.size());
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::sort(order.begin(), order.end(), [&](size_t l, size_t r) {
+            return boxes[l].minX < boxes[r].minX;
+        });
+        std::vector<FigurePair> result;
+        std::vector<size_t> active;
+        for (size_t index : order) {
+            const BoundingBox& box = boxes[index];
+            active.erase(std::remove_if(active.begin(), active.end(), [&](size_t other) {
+                return boxes[other].maxX < box.minX;
+            }), active.end());
+            for (size_t other : active) {
+                if (boxes[other].minY <= box.maxY && box.minY <= boxes[other].maxY) {
+                    result.push_back(std::make_pair(std::min(index, other), std::max(index, other)));
+                }
+            }
+            active.push_back(index);
+        }
+        return result;
+    }
+
+    std::vector<ConvexPolygon> snapshot(const FigureArray& figures) {
+        std::vector<ConvexPolygon> polygons(figures.size());
+        Parallel::forBlocks(figures.size(), SNAPSHOT_BLOCK, [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                polygons[i] = ConvexPolygon::fromFigure(*figures.at(i));
+            }
+        });
+        return polygons;
+    }
+
+    std::vector<FigurePair> findOverlaps(const FigureArray& figures) {
+        return findOverlaps(snapshot(figures));
+    }
+
+    std::vector<FigurePair> findOverlaps(const std::vector<ConvexPolygon>& polygons) {
+        std::vector<BoundingBox> boxes(polygons.size());
+        for (size_t i = 0; i < polygons.size(); ++i) {
+            boxes[i] = polygons[i].bounds();
+        }
+        std::vector<FigurePair> candidates = candidatePairs(boxes);
+
+        std::vector<std::vector<FigurePair>> found(Parallel::workerCount(candidates.size(), NARROW_PHASE_BLOCK));
+        Parallel::forBlocks(candidates.size(), NARROW_PHASE_BLOCK, [&](size_t worker, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const FigurePair& pair = candidates[i];
+                if (overlaps(polygons[pair.first], polygons[pair.second])) {
+                    found[worker].push_back(pair);
+                }
+            }
+        });
+        std::vector<FigurePair> result;
+        for (const auto& part : found) {
+            result.insert(result.end(), part.begin(), part.end());
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    std::vector<double> intersectionAreas(const FigureArray& figures, const std::vector<FigurePair>& pairs) {
+        return intersectionAreas(snapshot(figures), pairs);
+    }
+
+    std::vector<double> intersectionAreas(const std::vector<ConvexPolygon>& polygons,
+                                          const std::vector<FigurePair>& pairs) {
+        std::vector<double> result(pairs.size());
+        Parallel::forBlocks(pairs.size(), NARROW_PHASE_BLOCK, [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                result[i] = intersectionArea(polygons.at(pairs[i].first), polygons.at(pairs[i].second));
+            }
+        });
+        return result;
+    }
+}
@@ -0,0 +1,107 @@
+#include "concurrent_array.h"
+#include <stdexcept>
+
+ConcurrentFigureArray::ConcurrentFigureArray() : current(new Version(0, FigureArray())) {
+    versions[0] = current.load();
+}
+
+ConcurrentFigureArray::~ConcurrentFigureArray() {
+    delete current.load();
+}
+
+bool ConcurrentFigureArray::acquire(Version* version) {
+    // Обнулённый счётчик не поднимается: версия уже отдана на освобождение.
+    size_t refs = version->refs.load();
+    while (refs != 0) {
+        if (version->refs.compare_exchange_weak(refs, refs + 1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ConcurrentFigureArray::release(Version* version) const {
+    if (version->refs.fetch_sub(1) != 1) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(versionsMutex);
+        versions.erase(version->number);
+    }
+    // Читатели read() могут ещё обходить её - удаление через эпохи.
+    reclaimer.retire(version);
+}
+
+void ConcurrentFigureArray::publish(Version* next) {
+    {
+        std::lock_guard<std::mutex> lock(versionsMutex);
+        versions[next->number] = next;
+    }
+    Version* old = current.exchange(next);
+    release(old);
+    reclaimer.collect();
+}
+
+ConcurrentFigureArray::Snapshot ConcurrentFigureArray::snapshot() const {
+    EpochReclaimer::Guard guard(reclaimer);
+    for (;;) {
+        Version* version = current.load();
+        if (acquire(version)) {
+            return Snapshot(this, version);
+        }
+        // Версию только что сменили и отпустили - берём новую текущую.
+    }
+}
+
+ConcurrentFigureArray::Snapshot ConcurrentFigureArray::snapshot(uint64_t number) const {
+    std::lock_guard<std::mutex> lock(versionsMutex);
+    auto it = versions.find(number);
+    if (it == versions.end() || !acquire(it->second)) {
+        throw std::out_of_range("Version is no longer retained");
+    }
+    return Snapshot(this, it->second);
+}
+
+ConcurrentFigureArray::Snapshot& ConcurrentFigureArray::Snapshot::operator=(Snapshot&& other) noexcept {
+    if (this != &other) {
+        if (pinned) {
+            owner->release(pinned);
+        }
+        owner = other.owner;
+        pinned = other.pinned;
+        other.pinned = nullptr;
+    }
+    return *this;
+}
+
+ConcurrentFigureArray::Snapshot::~Snapshot() {
+    if (pinned) {
+        owner->release(pinned);
+    }
+}
+
+uint64_t ConcurrentFigureArray::addFigure(std::shared_ptr<const Figure> fig) {
+    return update([&fig](FigureArray& figures) { figures.addFigure(std::move(fig)); });
+}
+
+uint64_t ConcurrentFigureArray::removeFigure(size_t index) {
+    return update([index](FigureArray& figures) { figures.removeFigure(index); });
+}
+
+uint64_t ConcurrentFigureArray::setVertex(size_t index, size_t vertex, const Point& p) {
+    return update([&](FigureArray& figures) { figures.setVertex(index, vertex, p); });
+}
+
+uint64_t ConcurrentFigureArray::replaceFigure(size_t index, std::shared_ptr<const Figure> fig) {
+    return update([&](FigureArray& figures) { figures.replaceFigure(index, std::move(fig)); });
+}
+
+size_t ConcurrentFigureArray::reclaim() {
+    std::lock_guard<std::mutex> lock(writer);
+    return reclaimer.collect();
+}
+
+size_t ConcurrentFigureArray::retainedVersions() const {
+    std::lock_guard<std::mutex> lock(versionsMutex);
+    return versions.size();
+}
@@ -0,0 +1,170 @@
+#include "convex_hull.h"
+#include "predicates.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const size_t HULL_BLOCK = 8192;
+
+    bool lessXY(const Point& a, const Point& b) {
+        return a.x < b.x || (a.x == b.x && a.y < b.y);
+    }
+
+    bool sameXY(const Point& a, const Point& b) {
+        return a.x == b.x && a.y == b.y;
+    }
+
+    // Монотонная цепочка Эндрю с точным предикатом поворота.
+    std::vector<Point> monotoneChain(std::vector<Point> points) {
+        std::sort(points.begin(), points.end(), lessXY);
+        points.erase(std::unique(points.begin(), points.end(), sameXY), points.end());
+        if (points.size() < 3) {
+            return points;
+        }
+        std::vector<Point> result(2 * points.size());
+        size_t k = 0;
+        for (size_t i = 0; i < points.size(); ++i) {
+            while (k >= 2 && Predicates::orientation(result[k - 2], result[k - 1], points[i]) <= 0) {
+                --k;
+            }
+            result[k++] = points[i];
+        }
+        for (size_t i = points.size() - 1, lower = k + 1; i > 0; --i) {
+            while (k >= lower && Predicates::orientation(result[k - 2], result[k - 1], points[i - 1]) <= 0) {
+                --k;
+            }
+            result[k++] = points[i - 1];
+        }
+        result.resize(k - 1);
+        return result;
+    }
+
+    // Фильтр Экла-Туссена: выбрасывает точки строго внутри восьмиугольника
+    // из крайних точек по x, y, x + y и x - y.
+    void aklToussaint(std::vector<Point>& points) {
+        if (points.size() < 16) {
+            return;
+        }
+        Point extremes[8] = {points[0], points[0], points[0], points[0], points[0], points[0], points[0], points[0]};
+        for (const Point& p : points) {
+            if (p.x < extremes[0].x) extremes[0] = p;
+            if (p.x - p.y < extremes[1].x - extremes[1].y) extremes[1] = p;
+            if (p.y < extremes[2].y) extremes[2] = p;
+            if (p.x + p.y > extremes[3].x + extremes[3].y) extremes[3] = p;
+            if (p.x > extremes[4].x) extremes[4] = p;
+            if (p.x - p.y > extremes[5].x - extremes[5].y) extremes[5] = p;
+            if (p.y > extremes[6].y) extremes[6] = p;
+            if (p.x + p.y < extremes[7].x + extremes[7].y) extremes[7] = p;
+        }
+        std::vector<Point> octagon = monotoneChain(std::vector<Point>(extremes, extremes + 8));
+        if (octagon.size() < 3) {
+            return;
+        }
+        points.erase(std::remove_if(points.begin(), points.end(), [&](const Point& p) {
+            for (size_t i = 0; i < octagon.size(); ++i) {
+                if (Predicates::orientation(octagon[i], octagon[(i + 1) % octagon.size()], p) <= 0) {
+                    return false;
+                }
+            }
+            return true;
+        }), points.end());
+    }
+
+    std::vector<Point> blockHull(const FigureArray& figures, size_t begin, size_t end) {
+        std::vector<Point> points;
+        for (size_t i = begin; i < end; ++i) {
+            const Figure& fig = *figures.at(i);
+            for (size_t j = 0; j < fig.vertexCount(); ++j) {
+                points.push_back(fig.getVertex(j));
+            }
+        }
+        aklToussaint(points);
+        return monotoneChain(std::move(points));
+    }
+}
+
+ConvexHull ConvexHull::of(const FigureArray& figures) {
+    std::vector<std::vector<Point>> partial(Parallel::workerCount(figures.size(), HULL_BLOCK));
+    Parallel::forBlocks(figures.size(), HULL_BLOCK, [&](size_t worker, size_t begin, size_t end) {
+        partial[worker] = blockHull(figures, begin, end);
+    });
+    std::vector<Point> merged;
+    for (const auto& part : partial) {
+        merged.insert(merged.end(), part.begin(), part.end());
+    }
+    ConvexHull result;
+    result.hull = monotoneChain(std::move(merged));
+    return result;
+}
+
+ConvexHull ConvexHull::of(std::vector<Point> points) {
+    aklToussaint(points);
+    ConvexHull result;
+    result.hull = monotoneChain(std::move(points));
+    return result;
+}
+
+void ConvexHull::addPoints(const Point* points, size_t count) {
+    std::vector<Point> outside;
+    for (size_t i = 0; i < count; ++i) {
+        if (!contains(points[i])) {
+            outside.push_back(points[i]);
+        }
+    }
+    if (outside.empty()) {
+        return;
+    }
+    outside.insert(outside.end(), hull.begin(), hull.end());
+    hull = monotoneChain(std::move(outside));
+}
+
+void ConvexHull::addFigure(const Figure& fig) {
+    std::vector<Point> points(fig.vertexCount());
+    for (size_t i = 0; i < points.size(); ++i) {
+        points[i] = fig.getVertex(i);
+    }
+    addPoints(points.data(), points.size());
+}
+
+void ConvexHull::addFigures(const FigureArray& figures) {
+    ConvexHull added = of(figures);
+    addPoints(added.hull.data(), added.hull.size());
+}
+
+bool ConvexHull::contains(const Point& p) const {
+    if (hull.empty()) {
+        return false;
+    }
+    if (hull.size() == 1) {
+        return sameXY(hull[0], p);
+    }
+    if (hull.size() == 2) {
+        return Predicates::orientation(hull[0], hull[1], p) == 0 &&
+               p.x >= std::min(hull[0].x, hull[1].x) && p.x <= std::max(hull[0].x, hull[1].x) &&
+               p.y >= std::min(hull[0].y, hull[1].y) && p.y <= std::max(hull[0].y, hull[1].y);
+    }
+    for (size_t i = 0; i < hull.size(); ++i) {
+        if (Predicates::orientation(hull[i], hull[(i + 1) % hull.size()], p) < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+double ConvexHull::area() const {
+    double area = 0;
+    for (size_t i = 0; i < hull.size(); ++i) {
+        size_t j = (i + 1) % hull.size();
+        area += hull[i].x * hull[j].y - hull[j].x * hull[i].y;
+    }
+    return std::abs(area) / 2.0;
+}
+
+BoundingBox ConvexHull::bounds() const {
+    BoundingBox box;
+    for (const Point& p : hull) {
+        box.expand(p);
+    }
+    return box;
+}
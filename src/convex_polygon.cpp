@@ -0,0 +1,99 @@
+#include "convex_polygon.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+ConvexPolygon ConvexPolygon::fromFigure(const Figure& fig) {
+    size_t n = fig.vertexCount();
+    if (n > MAX_VERTICES) {
+        throw std::runtime_error("Figure has too many vertices for ConvexPolygon");
+    }
+    ConvexPolygon result;
+    for (size_t i = 0; i < n; ++i) {
+        result.vertices[i] = fig.getVertex(i);
+    }
+    result.count = n;
+    result.makeCounterClockwise();
+    return result;
+}
+
+void ConvexPolygon::add(const Point& p) {
+    if (count >= MAX_VERTICES) {
+        throw std::runtime_error("ConvexPolygon vertex capacity exceeded");
+    }
+    vertices[count++] = p;
+}
+
+double ConvexPolygon::signedArea() const {
+    double area = 0;
+    for (size_t i = 0; i < count; ++i) {
+        size_t j = (i + 1) % count;
+        area += vertices[i].x * vertices[j].y - vertices[j].x * vertices[i].y;
+    }
+    return area / 2.0;
+}
+
+double ConvexPolygon::area() const {
+    return std::abs(signedArea());
+}
+
+double ConvexPolygon::perimeter() const {
+    double result = 0;
+    for (size_t i = 0; i < count; ++i) {
+        result += GeometryUtils::distance(vertices[i], vertices[(i + 1) % count]);
+    }
+    return result;
+}
+
+Point ConvexPolygon::geometricCenter() const {
+    double sum_x = 0, sum_y = 0;
+    for (size_t i = 0; i < count; ++i) {
+        sum_x += vertices[i].x;
+        sum_y += vertices[i].y;
+    }
+    return count == 0 ? Point() : Point(sum_x / count, sum_y / count);
+}
+
+BoundingBox ConvexPolygon::bounds() const {
+    BoundingBox box;
+    for (size_t i = 0; i < count; ++i) {
+        box.expand(vertices[i]);
+    }
+    return box;
+}
+
+bool ConvexPolygon::contains(const Point& p) const {
+    if (count < 3) {
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (GeometryUtils::crossProduct(vertices[i], vertices[(i + 1) % count], p) < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+double ConvexPolygon::distanceTo(const Point& p) const {
+    if (contains(p)) {
+        return 0;
+    }
+    double best = std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < count; ++i) {
+        const Point& a = vertices[i];
+        const Point& b = vertices[(i + 1) % count];
+        double dx = b.x - a.x, dy = b.y - a.y;
+        double lengthSq = dx * dx + dy * dy;
+        double t = lengthSq > 0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / lengthSq : 0;
+        t = std::max(0.0, std::min(1.0, t));
+        best = std::min(best, GeometryUtils::distance(p, Point(a.x + t * dx, a.y + t * dy)));
+    }
+    return best;
+}
+
+void ConvexPolygon::makeCounterClockwise() {
+    if (signedArea() < 0) {
+        std::reverse(vertices, vertices + count);
+    }
+}
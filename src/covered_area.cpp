@@ -0,0 +1,393 @@
+#include "covered_area.h"
+#include "collision.h"
+#include "parallel.h"
+#include "predicates.h"
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+
+namespace {
+    const size_t STRIP_BLOCK = 256;
+    const size_t NONE = static_cast<size_t>(-1);
+
+    // Невертикальное ребро: y = offset + slope * u, где u = x - base (общая
+    // для всех рёбер точка отсчёта). Нижняя граница многоугольника (внутри
+    // выше ребра) даёт +1 к глубине покрытия, верхняя -1.
+    struct SweepEdge {
+        double slope, offset;
+        int delta;
+        size_t start, end; // ребро пересекает полосы [start, end)
+    };
+
+    struct Crossing {
+        double x;
+        size_t first, second;
+    };
+
+    // Рёбра, пересекающие текущую полосу, упорядоченные снизу вверх, -
+    // декартово дерево с указателями на родителя (вставка по сравнению,
+    // удаление по номеру ребра). Каждый узел хранит промежуток до следующего
+    // ребра как линейную функцию u, а поддерево - сумму +-1, минимальную
+    // глубину после своих рёбер и сумму промежутков с этой глубиной. Глубина
+    // 0 - промежуток вне объединения, поэтому длина сечения объединения
+    // читается из корня за O(1), а вставка и удаление стоят O(log A).
+    class ActiveEdges {
+    private:
+        struct Node {
+            size_t left = NONE, right = NONE, parent = NONE;
+            uint64_t priority = 0;
+            double gapSlope = 0, gapOffset = 0;     // до следующего ребра
+            int sum = 0, minDepth = 0;               // по поддереву
+            double minSlope = 0, minOffset = 0;      // промежутки с глубиной minDepth
+            double totalSlope = 0, totalOffset = 0;  // все промежутки
+        };
+
+        const std::vector<SweepEdge>& edges;
+        std::vector<Node> nodes;
+        size_t root = NONE;
+        double at = 0; // u, в которой сравниваются рёбра
+
+        double y(size_t e) const { return edges[e].offset + edges[e].slope * at; }
+
+        bool below(size_t a, size_t b) const {
+            double ya = y(a), yb = y(b);
+            if (ya != yb) {
+                return ya < yb;
+            }
+            if (edges[a].slope != edges[b].slope) {
+                return edges[a].slope < edges[b].slope;
+            }
+            return a < b;
+        }
+
+        void pull(size_t n) {
+            Node& node = nodes[n];
+            int sum = 0;
+            bool any = false;
+            node.totalSlope = node.gapSlope;
+            node.totalOffset = node.gapOffset;
+            auto consider = [&](int depth, double slope, double offset) {
+                if (!any || depth < node.minDepth) {
+                    node.minDepth = depth;
+                    node.minSlope = slope;
+                    node.minOffset = offset;
+                    any = true;
+                } else if (depth == node.minDepth) {
+                    node.minSlope += slope;
+                    node.minOffset += offset;
+                }
+            };
+            if (node.left != NONE) {
+                const Node& left = nodes[node.left];
+                consider(left.minDepth, left.minSlope, left.minOffset);
+                sum = left.sum;
+                node.totalSlope += left.totalSlope;
+                node.totalOffset += left.totalOffset;
+            }
+            sum += edges[n].delta;
+            consider(sum, node.gapSlope, node.gapOffset);
+            if (node.right != NONE) {
+                const Node& right = nodes[node.right];
+                consider(sum + right.minDepth, right.minSlope, right.minOffset);
+                sum += right.sum;
+                node.totalSlope += right.totalSlope;
+                node.totalOffset += right.totalOffset;
+            }
+            node.sum = sum;
+        }
+
+        void pullPath(size_t n) {
+            for (; n != NONE; n = nodes[n].parent) {
+                pull(n);
+            }
+        }
+
+        void replaceChild(size_t parent, size_t from, size_t to) {
+            if (parent == NONE) {
+                root = to;
+            } else if (nodes[parent].left == from) {
+                nodes[parent].left = to;
+            } else {
+                nodes[parent].right = to;
+            }
+            if (to != NONE) {
+                nodes[to].parent = parent;
+            }
+        }
+
+        void rotateUp(size_t n) {
+            size_t p = nodes[n].parent;
+            size_t grand = nodes[p].parent;
+            if (nodes[p].left == n) {
+                nodes[p].left = nodes[n].right;
+                if (nodes[n].right != NONE) {
+                    nodes[nodes[n].right].parent = p;
+                }
+                nodes[n].right = p;
+            } else {
+                nodes[p].right = nodes[n].left;
+                if (nodes[n].left != NONE) {
+                    nodes[nodes[n].left].parent = p;
+                }
+                nodes[n].left = p;
+            }
+            nodes[p].parent = n;
+            replaceChild(grand, p, n);
+            pull(p);
+            pull(n);
+        }
+
+        size_t neighbour(size_t n, bool next) const {
+            size_t child = next ? nodes[n].right : nodes[n].left;
+            if (child != NONE) {
+                while ((next ? nodes[child].left : nodes[child].right) != NONE) {
+                    child = next ? nodes[child].left : nodes[child].right;
+                }
+                return child;
+            }
+            size_t parent = nodes[n].parent;
+            while (parent != NONE && (next ? nodes[parent].right : nodes[parent].left) == n) {
+                n = parent;
+                parent = nodes[n].parent;
+            }
+            return parent;
+        }
+
+        void setGap(size_t n, size_t next) {
+            nodes[n].gapSlope = next == NONE ? 0 : edges[next].slope - edges[n].slope;
+            nodes[n].gapOffset = next == NONE ? 0 : edges[next].offset - edges[n].offset;
+        }
+
+    public:
+        explicit ActiveEdges(const std::vector<SweepEdge>& edges) : edges(edges), nodes(edges.size()) {}
+
+        void moveTo(double u) { at = u; }
+
+        void insert(size_t e) {
+            Node& node = nodes[e];
+            node = Node();
+            uint64_t h = (e + 1) * 0x9E3779B97F4A7C15ULL;
+            h ^= h >> 31;
+            node.priority = h * 0xBF58476D1CE4E5B9ULL;
+            size_t parent = NONE;
+            bool left = false;
+            for (size_t current = root; current != NONE;) {
+                parent = current;
+                left = below(e, current);
+                current = left ? nodes[current].left : nodes[current].right;
+            }
+            node.parent = parent;
+            if (parent == NONE) {
+                root = e;
+            } else if (left) {
+                nodes[parent].left = e;
+            } else {
+                nodes[parent].right = e;
+            }
+            pull(e);
+            while (nodes[e].parent != NONE && nodes[nodes[e].parent].priority < nodes[e].priority) {
+                rotateUp(e);
+            }
+            size_t previous = neighbour(e, false);
+            setGap(e, neighbour(e, true));
+            pullPath(e);
+            if (previous != NONE) {
+                setGap(previous, e);
+                pullPath(previous);
+            }
+        }
+
+        void erase(size_t e) {
+            size_t previous = neighbour(e, false);
+            size_t next = neighbour(e, true);
+            while (nodes[e].left != NONE && nodes[e].right != NONE) {
+                size_t left = nodes[e].left, right = nodes[e].right;
+                rotateUp(nodes[left].priority > nodes[right].priority ? left : right);
+            }
+            size_t child = nodes[e].left != NONE ? nodes[e].left : nodes[e].right;
+            size_t parent = nodes[e].parent;
+            replaceChild(parent, e, child);
+            pullPath(parent);
+            if (previous != NONE) {
+                setGap(previous, next);
+                pullPath(previous);
+            }
+        }
+
+        // Длина сечения объединения прямой x = base + u; u - внутри текущей полосы.
+        double coveredLength(double u) const {
+            if (root == NONE) {
+                return 0;
+            }
+            const Node& top = nodes[root];
+            double total = top.totalSlope * u + top.totalOffset;
+            double uncovered = top.minDepth <= 0 ? top.minSlope * u + top.minOffset : 0;
+            return total - uncovered;
+        }
+    };
+
+    struct Sweep {
+        std::vector<double> xs;
+        double base = 0;
+        std::vector<SweepEdge> edges;
+        // по границе полосы k: рёбра, которые на ней кончаются, начинаются и пересекаются
+        std::vector<std::vector<size_t>> endsAt, startsAt, crossAt;
+
+        double middle(size_t k) const { return (xs[k] + xs[k + 1]) / 2.0 - base; }
+    };
+
+    // Точки собственного пересечения рёбер двух многоугольников; edgeA[i] -
+    // номер SweepEdge ребра i многоугольника a (NONE для вертикальных).
+    void addCrossings(const ConvexPolygon& a, const size_t* edgeA, const ConvexPolygon& b, const size_t* edgeB,
+                      std::vector<Crossing>& crossings) {
+        for (size_t i = 0; i < a.count; ++i) {
+            if (edgeA[i] == NONE) {
+                continue;
+            }
+            const Point& p = a[i];
+            const Point& q = a[(i + 1) % a.count];
+            for (size_t j = 0; j < b.count; ++j) {
+                if (edgeB[j] == NONE) {
+                    continue;
+                }
+                const Point& r = b[j];
+                const Point& s = b[(j + 1) % b.count];
+                if (Predicates::orientation(p, q, r) * Predicates::orientation(p, q, s) >= 0) {
+                    continue;
+                }
+                double d3 = Predicates::orient2d(r, s, p);
+                double d4 = Predicates::orient2d(r, s, q);
+                if ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0)) {
+                    double t = d3 / (d3 - d4);
+                    crossings.push_back({p.x + t * (q.x - p.x), edgeA[i], edgeB[j]});
+                }
+            }
+        }
+    }
+
+    // Площадь объединения в полосах [xs[first], xs[last]].
+    double sweepStrips(const Sweep& sweep, size_t first, size_t last) {
+        ActiveEdges active(sweep.edges);
+        active.moveTo(sweep.middle(first));
+        for (size_t e = 0; e < sweep.edges.size(); ++e) {
+            if (sweep.edges[e].start <= first && sweep.edges[e].end > first) {
+                active.insert(e);
+            }
+        }
+        std::vector<size_t> reordered;
+        std::vector<size_t> mark(sweep.edges.size(), NONE);
+        double area = 0;
+        for (size_t k = first; k < last; ++k) {
+            if (k > first) {
+                for (size_t e : sweep.endsAt[k]) {
+                    active.erase(e);
+                }
+                // Пересекающиеся на границе рёбра меняются местами: вынимаем и
+                // вставляем заново уже по порядку новой полосы.
+                reordered.clear();
+                for (size_t e : sweep.crossAt[k]) {
+                    if (mark[e] != k && sweep.edges[e].start < k && sweep.edges[e].end > k) {
+                        mark[e] = k;
+                        reordered.push_back(e);
+                        active.erase(e);
+                    }
+                }
+                active.moveTo(sweep.middle(k));
+                for (size_t e : reordered) {
+                    active.insert(e);
+                }
+                for (size_t e : sweep.startsAt[k]) {
+                    active.insert(e);
+                }
+            }
+            area += active.coveredLength(sweep.middle(k)) * (sweep.xs[k + 1] - sweep.xs[k]);
+        }
+        return area;
+    }
+}
+
+namespace Coverage {
+    double unionArea(const std::vector<ConvexPolygon>& polygons, bool parallel) {
+        Sweep sweep;
+        std::vector<BoundingBox> boxes(polygons.size());
+        for (size_t i = 0; i < polygons.size(); ++i) {
+            boxes[i] = polygons[i].bounds();
+            for (size_t j = 0; j < polygons[i].count; ++j) {
+                sweep.xs.push_back(polygons[i][j].x);
+            }
+        }
+        if (sweep.xs.empty()) {
+            return 0;
+        }
+        sweep.base = *std::min_element(sweep.xs.begin(), sweep.xs.end());
+
+        // edgeOf[i * MAX_VERTICES + j] - SweepEdge ребра j многоугольника i.
+        std::vector<size_t> edgeOf(polygons.size() * ConvexPolygon::MAX_VERTICES, NONE);
+        std::vector<std::pair<double, double>> spans;
+        for (size_t i = 0; i < polygons.size(); ++i) {
+            const ConvexPolygon& poly = polygons[i];
+            double orientation = poly.signedArea();
+            if (poly.count < 3 || orientation == 0) {
+                continue;
+            }
+            for (size_t j = 0; j < poly.count; ++j) {
+                const Point& p = poly[j];
+                const Point& q = poly[(j + 1) % poly.count];
+                if (p.x == q.x) {
+                    continue;
+                }
+                SweepEdge edge;
+                edge.slope = (q.y - p.y) / (q.x - p.x);
+                edge.offset = p.y + edge.slope * (sweep.base - p.x);
+                // против часовой стрелки внутренность слева от ребра: при движении
+                // вправо она выше - это нижняя граница
+                edge.delta = (q.x > p.x) == (orientation > 0) ? 1 : -1;
+                edgeOf[i * ConvexPolygon::MAX_VERTICES + j] = sweep.edges.size();
+                sweep.edges.push_back(edge);
+                spans.emplace_back(std::min(p.x, q.x), std::max(p.x, q.x));
+            }
+        }
+
+        std::vector<Crossing> crossings;
+        for (const FigurePair& pair : Collision::candidatePairs(boxes)) {
+            addCrossings(polygons[pair.first], &edgeOf[pair.first * ConvexPolygon::MAX_VERTICES],
+                         polygons[pair.second], &edgeOf[pair.second * ConvexPolygon::MAX_VERTICES], crossings);
+        }
+        for (const Crossing& crossing : crossings) {
+            sweep.xs.push_back(crossing.x);
+        }
+        std::sort(sweep.xs.begin(), sweep.xs.end());
+        sweep.xs.erase(std::unique(sweep.xs.begin(), sweep.xs.end()), sweep.xs.end());
+        if (sweep.xs.size() < 2) {
+            return 0;
+        }
+
+        auto boundary = [&](double x) {
+            return static_cast<size_t>(std::lower_bound(sweep.xs.begin(), sweep.xs.end(), x) - sweep.xs.begin());
+        };
+        sweep.endsAt.resize(sweep.xs.size());
+        sweep.startsAt.resize(sweep.xs.size());
+        sweep.crossAt.resize(sweep.xs.size());
+        for (size_t e = 0; e < sweep.edges.size(); ++e) {
+            sweep.edges[e].start = boundary(spans[e].first);
+            sweep.edges[e].end = boundary(spans[e].second);
+            sweep.startsAt[sweep.edges[e].start].push_back(e);
+            sweep.endsAt[sweep.edges[e].end].push_back(e);
+        }
+        for (const Crossing& crossing : crossings) {
+            size_t k = boundary(crossing.x);
+            sweep.crossAt[k].push_back(crossing.first);
+            sweep.crossAt[k].push_back(crossing.second);
+        }
+
+        size_t strips = sweep.xs.size() - 1;
+        if (!parallel) {
+            return sweepStrips(sweep, 0, strips);
+        }
+        std::vector<double> partial(Parallel::workerCount(strips, STRIP_BLOCK), 0.0);
+        Parallel::forBlocks(strips, STRIP_BLOCK, [&](size_t worker, size_t begin, size_t end) {
+            partial[worker] = sweepStrips(sweep, begin, end);
+        });
+        return std::accumulate(partial.begin(), partial.end(), 0.0);
+    }
+}
@@ -0,0 +1,281 @@
+#include "durable_array.h"
+#include "mapped_store.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const size_t DurableFigureArray::DEFAULT_COMPACT_BYTES;
+
+namespace {
+    const char SEGMENT_PREFIX[] = "wal-";
+    const char SEGMENT_SUFFIX[] = ".log";
+
+    bool exists(const std::string& path) {
+        struct stat info;
+        return ::stat(path.c_str(), &info) == 0;
+    }
+
+    // rename() долговечен только после синхронизации каталога.
+    void syncDirectory(const std::string& directory) {
+        int fd = ::open(directory.c_str(), O_RDONLY);
+        if (fd < 0 || ::fsync(fd) != 0) {
+            std::string error = std::strerror(errno);
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            throw std::runtime_error("Cannot sync " + directory + ": " + error);
+        }
+        ::close(fd);
+    }
+
+    // Номера сегментов журнала "wal-<номер>.log" по возрастанию.
+    std::vector<uint64_t> listSegments(const std::string& directory) {
+        std::vector<uint64_t> result;
+        DIR* dir = ::opendir(directory.c_str());
+        if (!dir) {
+            throw std::runtime_error("Cannot list " + directory + ": " + std::strerror(errno));
+        }
+        size_t prefix = sizeof(SEGMENT_PREFIX) - 1;
+        size_t suffix = sizeof(SEGMENT_SUFFIX) - 1;
+        while (dirent* item = ::readdir(dir)) {
+            std::string name = item->d_name;
+            if (name.size() > prefix + suffix && name.compare(0, prefix, SEGMENT_PREFIX) == 0 &&
+                name.compare(name.size() - suffix, suffix, SEGMENT_SUFFIX) == 0) {
+                std::string digits = name.substr(prefix, name.size() - prefix - suffix);
+                if (digits.find_first_not_of("0123456789") == std::string::npos) {
+                    result.push_back(std::strtoull(digits.c_str(), nullptr, 10));
+                }
+            }
+        }
+        ::closedir(dir);
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    double millisSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+std::string DurableFigureArray::segmentPath(uint64_t number) const {
+    return directory + "/" + SEGMENT_PREFIX + std::to_string(number) + SEGMENT_SUFFIX;
+}
+
+DurableFigureArray::DurableFigureArray(const std::string& directory, size_t compactAfterBytes)
+    : directory(directory), compactAfterBytes(compactAfterBytes), checkpointRunning(false), checkpointWritten(0) {
+    if (::mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        throw std::runtime_error("Cannot create " + directory + ": " + std::strerror(errno));
+    }
+    // Незавершённая контрольная точка: старый снимок и сегменты ещё действительны.
+    std::remove((snapshotPath() + ".tmp").c_str());
+
+    uint64_t cursor = 0;
+    if (exists(snapshotPath())) {
+        MappedFigureStore snapshot = MappedFigureStore::open(snapshotPath());
+        for (size_t i = 0; i < snapshot.size(); ++i) {
+            figures.addFigure(FigureRecords::restore(snapshot.record(i)));
+        }
+        cursor = snapshot.sequence();
+        report.sequence = cursor;
+    }
+    // Записи, уже вошедшие в снимок (сбой до удаления старых сегментов), пропускаются.
+    std::vector<uint64_t> segments = listSegments(directory);
+    if (segments.empty()) {
+        segments.push_back(1);
+    }
+    for (uint64_t number : segments) {
+        log = std::make_shared<FigureLog>(segmentPath(number), cursor, [this](const LogEntry& entry) {
+            apply(entry);
+        });
+        cursor = log->lastSequence();
+    }
+    oldestGeneration = segments.front();
+    generation = segments.back();
+}
+
+DurableFigureArray::~DurableFigureArray() {
+    waitForCheckpoint();
+}
+
+void DurableFigureArray::apply(const LogEntry& entry) {
+    switch (entry.op) {
+    case LogEntry::ADD:
+        // Фигура была принята при добавлении; проверка геометрии заново
+        // (с другим округлением) не должна делать хранилище неоткрываемым.
+        figures.addFigure(FigureRecords::restore(entry.figure));
+        return;
+    case LogEntry::REMOVE:
+        if (entry.index < figures.size()) {
+            figures.removeFigure(entry.index);
+            return;
+        }
+        break;
+    case LogEntry::SET_VERTEX:
+        if (entry.index < figures.size() && entry.vertex < figures.at(entry.index)->vertexCount()) {
+            figures.setVertex(entry.index, entry.vertex, entry.point);
+            return;
+        }
+        break;
+    }
+    throw std::runtime_error("Corrupted log in " + directory + ": entry " + std::to_string(entry.sequence) +
+                             " does not apply");
+}
+
+void DurableFigureArray::addFigure(std::shared_ptr<const Figure> fig) {
+    LogEntry entry;
+    entry.op = LogEntry::ADD;
+    entry.figure = FigureRecords::encode(*fig);
+    // Своя копия: вызывающий может менять фигуру дальше в обход журнала.
+    std::shared_ptr<const Figure> own = fig->clone();
+    std::lock_guard<std::mutex> lock(mutex);
+    figures.addFigure(std::move(own));
+    log->append(entry);
+}
+
+void DurableFigureArray::removeFigure(size_t index) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (index >= figures.size()) {
+        return;
+    }
+    figures.removeFigure(index);
+    LogEntry entry;
+    entry.op = LogEntry::REMOVE;
+    entry.index = index;
+    log->append(entry);
+}
+
+void DurableFigureArray::setVertex(size_t index, size_t vertex, const Point& p) {
+    std::lock_guard<std::mutex> lock(mutex);
+    figures.setVertex(index, vertex, p);
+    LogEntry entry;
+    entry.op = LogEntry::SET_VERTEX;
+    entry.index = index;
+    entry.vertex = static_cast<uint32_t>(vertex);
+    entry.point = p;
+    log->append(entry);
+}
+
+void DurableFigureArray::commit() {
+    std::shared_ptr<FigureLog> current;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current = log;
+    }
+    // Вне блокировки: сюда одновременно приходят потоки, чьи записи сбросятся вместе.
+    current->commit();
+    if (current->size() > compactAfterBytes) {
+        startCheckpoint();
+    }
+}
+
+bool DurableFigureArray::startCheckpoint() {
+    std::lock_guard<std::mutex> threadLock(checkpointMutex);
+    if (checkpointRunning) {
+        return false;
+    }
+    if (checkpointThread.joinable()) {
+        checkpointThread.join();
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    auto started = std::chrono::steady_clock::now();
+    // Записи старого сегмента должны стать долговечными раньше записей нового.
+    log->commit();
+    FigureArray table = figures;
+    uint64_t sequence = log->lastSequence();
+    std::shared_ptr<FigureLog> next = std::make_shared<FigureLog>(segmentPath(generation + 1), sequence,
+                                                                 [](const LogEntry&) {});
+    log = next;
+    ++generation;
+
+    checkpointRunning = true;
+    checkpointWritten = 0;
+    {
+        std::lock_guard<std::mutex> reportLock(reportMutex);
+        report.running = true;
+        report.written = 0;
+        report.total = table.size();
+        report.pauseMillis = millisSince(started);
+        report.durationMillis = 0;
+        report.error.clear();
+    }
+    checkpointThread = std::thread(&DurableFigureArray::writeSnapshot, this, std::move(table), sequence,
+                                   generation, started);
+    return true;
+}
+
+void DurableFigureArray::writeSnapshot(FigureArray table, uint64_t sequence,
+                                       uint64_t activeGeneration, std::chrono::steady_clock::time_point started) {
+    std::string error;
+    try {
+        std::string temporary = snapshotPath() + ".tmp";
+        {
+            MappedFigureStore snapshot = MappedFigureStore::create(temporary, table.size());
+            for (const auto& fig : table) {
+                snapshot.append(*fig);
+                ++checkpointWritten;
+            }
+            snapshot.setSequence(sequence);
+            snapshot.sync();
+        }
+        // Снимок больше не нужен: изменения снова идут без копирования.
+        table = FigureArray();
+        if (std::rename(temporary.c_str(), snapshotPath().c_str()) != 0) {
+            throw std::runtime_error("Cannot replace " + snapshotPath() + ": " + std::strerror(errno));
+        }
+        syncDirectory(directory);
+        for (uint64_t number = oldestGeneration; number < activeGeneration; ++number) {
+            std::remove(segmentPath(number).c_str());
+        }
+        oldestGeneration = activeGeneration;
+    } catch (const std::exception& e) {
+        error = e.what();
+    }
+    table = FigureArray();
+    std::lock_guard<std::mutex> reportLock(reportMutex);
+    report.running = false;
+    report.written = checkpointWritten;
+    report.durationMillis = millisSince(started);
+    report.error = error;
+    if (error.empty()) {
+        report.sequence = sequence;
+    }
+    checkpointRunning = false;
+}
+
+void DurableFigureArray::waitForCheckpoint() {
+    std::lock_guard<std::mutex> threadLock(checkpointMutex);
+    if (checkpointThread.joinable()) {
+        checkpointThread.join();
+    }
+}
+
+CheckpointReport DurableFigureArray::checkpointReport() const {
+    std::lock_guard<std::mutex> reportLock(reportMutex);
+    CheckpointReport result = report;
+    if (result.running) {
+        result.written = checkpointWritten;
+    }
+    return result;
+}
+
+void DurableFigureArray::compact() {
+    waitForCheckpoint();
+    startCheckpoint();
+    waitForCheckpoint();
+    std::string error = checkpointReport().error;
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+}
+
+size_t DurableFigureArray::logSize() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return log->size();
+}
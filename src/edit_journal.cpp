@@ -0,0 +1,166 @@
+#include "edit_journal.h"
+#include "figure_record.h"
+#include <stdexcept>
+#include <utility>
+
+const size_t EditJournal::DEFAULT_BUDGET;
+
+size_t EditJournal::cost(const Delta& delta) {
+    // Удалённая или заменённая фигура жива только благодаря журналу.
+    bool keepsFigure = delta.kind == Delta::REMOVE || delta.kind == Delta::REPLACE;
+    return sizeof(Delta) + (keepsFigure ? sizeof(FigureRecord) : 0);
+}
+
+void EditJournal::record(Delta delta) {
+    while (history.size() > applied) {
+        dropBack();
+    }
+    delta.step = openStep ? openStep : nextStep++;
+    used += cost(delta);
+    history.push_back(std::move(delta));
+    ++applied;
+    // Текущий шаг не обрезается, даже если сам больше бюджета.
+    while (used > budget && history.front().step != history.back().step) {
+        dropFront();
+    }
+}
+
+void EditJournal::dropFront() {
+    uint64_t step = history.front().step;
+    while (!history.empty() && history.front().step == step) {
+        used -= cost(history.front());
+        history.pop_front();
+        --applied;
+    }
+}
+
+void EditJournal::dropBack() {
+    used -= cost(history.back());
+    history.pop_back();
+}
+
+void EditJournal::addFigure(std::shared_ptr<const Figure> fig) {
+    Delta delta;
+    delta.kind = Delta::ADD;
+    delta.index = figures.size();
+    delta.figure = fig;
+    figures.addFigure(std::move(fig));
+    record(std::move(delta));
+}
+
+void EditJournal::removeFigure(size_t index) {
+    if (index >= figures.size()) {
+        return;
+    }
+    Delta delta;
+    delta.kind = Delta::REMOVE;
+    delta.index = index;
+    delta.figure = figures.at(index);
+    figures.removeFigure(index);
+    record(std::move(delta));
+}
+
+void EditJournal::setVertex(size_t index, size_t vertex, const Point& p) {
+    Delta delta;
+    delta.kind = Delta::SET_VERTEX;
+    delta.index = index;
+    delta.vertex = static_cast<uint32_t>(vertex);
+    delta.before = figures.at(index)->getVertex(vertex);
+    delta.after = p;
+    figures.setVertex(index, vertex, p);
+    record(std::move(delta));
+}
+
+void EditJournal::replaceFigure(size_t index, std::shared_ptr<const Figure> fig) {
+    Delta delta;
+    delta.kind = Delta::REPLACE;
+    delta.index = index;
+    delta.figure = figures.at(index);
+    delta.replacement = fig;
+    figures.replaceFigure(index, std::move(fig));
+    record(std::move(delta));
+}
+
+void EditJournal::moveFigure(size_t source, size_t target) {
+    std::shared_ptr<const Figure> moved = figures.at(source);
+    figures.at(target);
+    if (source == target) {
+        return;
+    }
+    beginStep();
+    removeFigure(source);
+    Delta delta;
+    delta.kind = Delta::ADD;
+    delta.index = target;
+    delta.figure = moved;
+    figures.insertFigure(target, std::move(moved));
+    record(std::move(delta));
+    endStep();
+}
+
+void EditJournal::beginStep() {
+    if (openStep) {
+        throw std::logic_error("Journal step is already open");
+    }
+    openStep = nextStep++;
+}
+
+void EditJournal::endStep() {
+    openStep = 0;
+}
+
+void EditJournal::revert(const Delta& delta) {
+    switch (delta.kind) {
+    case Delta::ADD:
+        figures.removeFigure(delta.index);
+        break;
+    case Delta::REMOVE:
+        figures.insertFigure(delta.index, delta.figure);
+        break;
+    case Delta::SET_VERTEX:
+        figures.setVertex(delta.index, delta.vertex, delta.before);
+        break;
+    case Delta::REPLACE:
+        figures.replaceFigure(delta.index, delta.figure);
+        break;
+    }
+}
+
+void EditJournal::reapply(const Delta& delta) {
+    switch (delta.kind) {
+    case Delta::ADD:
+        figures.insertFigure(delta.index, delta.figure);
+        break;
+    case Delta::REMOVE:
+        figures.removeFigure(delta.index);
+        break;
+    case Delta::SET_VERTEX:
+        figures.setVertex(delta.index, delta.vertex, delta.after);
+        break;
+    case Delta::REPLACE:
+        figures.replaceFigure(delta.index, delta.replacement);
+        break;
+    }
+}
+
+bool EditJournal::undo() {
+    if (!canUndo() || openStep) {
+        return false;
+    }
+    uint64_t step = history[applied - 1].step;
+    while (applied > 0 && history[applied - 1].step == step) {
+        revert(history[--applied]);
+    }
+    return true;
+}
+
+bool EditJournal::redo() {
+    if (!canRedo() || openStep) {
+        return false;
+    }
+    uint64_t step = history[applied].step;
+    while (applied < history.size() && history[applied].step == step) {
+        reapply(history[applied++]);
+    }
+    return true;
+}
@@ -0,0 +1,97 @@
+#include "epoch.h"
+#include <functional>
+#include <stdexcept>
+#include <thread>
+
+const size_t EpochReclaimer::MAX_READERS;
+const uint64_t EpochReclaimer::IDLE;
+
+size_t EpochReclaimer::acquire() {
+    // Поиск начинается с места, зависящего от потока, чтобы потоки не делили строки кэша.
+    size_t start = std::hash<std::thread::id>()(std::this_thread::get_id()) % MAX_READERS;
+    for (;;) {
+        for (size_t k = 0; k < MAX_READERS; ++k) {
+            size_t i = (start + k) % MAX_READERS;
+            bool expected = false;
+            if (!slots[i].busy.load(std::memory_order_relaxed) &&
+                slots[i].busy.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return i;
+            }
+        }
+        std::this_thread::yield();
+    }
+}
+
+EpochReclaimer::Guard::Guard(EpochReclaimer& owner) : owner(&owner), slot(owner.acquire()) {
+    Slot& s = owner.slots[slot];
+    // Эпоха может сдвинуться между чтением и публикацией - тогда повторяем.
+    for (;;) {
+        uint64_t e = owner.global.load();
+        s.epoch.store(e);
+        if (owner.global.load() == e) {
+            break;
+        }
+    }
+}
+
+EpochReclaimer::Guard::~Guard() {
+    if (owner) {
+        Slot& s = owner->slots[slot];
+        s.epoch.store(IDLE, std::memory_order_release);
+        s.busy.store(false, std::memory_order_release);
+    }
+}
+
+EpochReclaimer::~EpochReclaimer() {
+    for (const Retired& r : retired) {
+        r.deleter(r.object);
+    }
+}
+
+void EpochReclaimer::retire(void* object, void (*deleter)(void*)) {
+    std::lock_guard<std::mutex> lock(retiredMutex);
+    retired.push_back(Retired{object, deleter, global.load()});
+}
+
+bool EpochReclaimer::tryAdvance() {
+    uint64_t current = global.load();
+    for (const Slot& s : slots) {
+        uint64_t e = s.epoch.load();
+        if (e != IDLE && e != current) {
+            return false;
+        }
+    }
+    global.compare_exchange_strong(current, current + 1);
+    return true;
+}
+
+size_t EpochReclaimer::collect() {
+    // Без закреплённых читателей двух шагов достаточно, чтобы освободить всё.
+    if (tryAdvance()) {
+        tryAdvance();
+    }
+    std::vector<Retired> ready;
+    {
+        std::lock_guard<std::mutex> lock(retiredMutex);
+        // Читатель мог закрепить эпоху retire-а или предыдущую; через две эпохи таких нет.
+        uint64_t safe = global.load();
+        size_t kept = 0;
+        for (const Retired& r : retired) {
+            if (r.epoch + 2 <= safe) {
+                ready.push_back(r);
+            } else {
+                retired[kept++] = r;
+            }
+        }
+        retired.resize(kept);
+    }
+    for (const Retired& r : ready) {
+        r.deleter(r.object);
+    }
+    return ready.size();
+}
+
+size_t EpochReclaimer::pending() {
+    std::lock_guard<std::mutex> lock(retiredMutex);
+    return retired.size();
+}
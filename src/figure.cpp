@@ -1,4 +1,8 @@
 #include "figure.h"
+#include "affine.h"
+#include "predicates.h"
+#include <algorithm>
+#include <limits>
 #include <stdexcept>
 
 bool Point::operator==(const Point& other) const {
@@ -6,6 +10,43 @@ bool Point::operator==(const Point& other) const {
            std::abs(y - other.y) < GeometryUtils::EPSILON;
 }
 
+BoundingBox::BoundingBox()
+    : minX(std::numeric_limits<double>::infinity()), minY(std::numeric_limits<double>::infinity()),
+      maxX(-std::numeric_limits<double>::infinity()), maxY(-std::numeric_limits<double>::infinity()) {}
+
+BoundingBox::BoundingBox(double minX, double minY, double maxX, double maxY)
+    : minX(minX), minY(minY), maxX(maxX), maxY(maxY) {}
+
+bool BoundingBox::isEmpty() const {
+    return minX > maxX || minY > maxY;
+}
+
+void BoundingBox::expand(const Point& p) {
+    minX = std::min(minX, p.x);
+    minY = std::min(minY, p.y);
+    maxX = std::max(maxX, p.x);
+    maxY = std::max(maxY, p.y);
+}
+
+void BoundingBox::expand(const BoundingBox& other) {
+    minX = std::min(minX, other.minX);
+    minY = std::min(minY, other.minY);
+    maxX = std::max(maxX, other.maxX);
+    maxY = std::max(maxY, other.maxY);
+}
+
+bool BoundingBox::intersects(const BoundingBox& other) const {
+    return minX <= other.maxX && other.minX <= maxX && minY <= other.maxY && other.minY <= maxY;
+}
+
+bool BoundingBox::contains(const Point& p) const {
+    return p.x >= minX && p.x <= maxX && p.y >= minY && p.y <= maxY;
+}
+
+bool BoundingBox::contains(const BoundingBox& other) const {
+    return other.minX >= minX && other.maxX <= maxX && other.minY >= minY && other.maxY <= maxY;
+}
+
 namespace GeometryUtils {
     double distance(const Point& a, const Point& b) {
         return std::sqrt((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y));
@@ -14,22 +55,61 @@ namespace GeometryUtils {
         return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
     }
     bool areParallel(const Point& a, const Point& b, const Point& c, const Point& d) {
-        double dx1 = b.x - a.x; // v1
-        double dy1 = b.y - a.y;
-        double dx2 = d.x - c.x; // v2
-        double dy2 = d.y - c.y;
-        if (std::abs(dx1 * dy2 - dy1 * dx2) > EPSILON) {
-            return false; // векторы || если их векторное произведение = нулю (-> 0)
+        // векторы не должны быть нулевыми
+        if ((a.x == b.x && a.y == b.y) || (c.x == d.x && c.y == d.y)) {
+            return false;
         }
-        double length1 = std::sqrt(dx1 * dx1 + dy1 * dy1);
-        double length2 = std::sqrt(dx2 * dx2 + dy2 * dy2);
-        return (length1 > EPSILON && length2 > EPSILON); // векторы не должны быть 0
+        // синус угла между векторами меньше EPSILON - допуск не зависит от масштаба;
+        // произведение считается адаптивно, без погрешности вычитания близких чисел
+        double cross = Predicates::cross2d(a, b, c, d);
+        return std::abs(cross) <= EPSILON * distance(a, b) * distance(c, d);
     }
     bool areCollinear(const Point& a, const Point& b, const Point& c) {
-        return std::abs(crossProduct(a, b, c)) < EPSILON;
+        // высота треугольника относительно его длиннейшей стороны
+        double longest = std::max(std::max(distance(a, b), distance(b, c)), distance(c, a));
+        return std::abs(Predicates::orient2d(a, b, c)) <= EPSILON * longest * longest;
+    }
+}
+
+namespace GeometryUtils {
+    double perimeter(const Figure& fig) {
+        size_t n = fig.vertexCount();
+        double result = 0;
+        for (size_t i = 0; i < n; ++i) {
+            result += distance(fig.getVertex(i), fig.getVertex((i + 1) % n));
+        }
+        return result;
+    }
+
+    BoundingBox boundingBox(const Figure& fig) {
+        BoundingBox box;
+        for (size_t i = 0; i < fig.vertexCount(); ++i) {
+            box.expand(fig.getVertex(i));
+        }
+        return box;
+    }
+}
+
+void Figure::transform(const AffineTransform& m) {
+    for (size_t i = 0; i < vertexCount(); ++i) {
+        setVertex(i, m.apply(getVertex(i)));
     }
 }
 
+bool Figure::transformMayFail(const AffineTransform&) const {
+    return true;
+}
+
+const char* Figure::typeName() const {
+    return "Figure";
+}
+
+Figure::CheckState Figure::checkState() const {
+    return CheckState::PENDING;
+}
+
+void Figure::restoreCheckState(CheckState) {}
+
 Figure::operator double() const {
     return area();
 }
@@ -0,0 +1,320 @@
+#include "figure_array.h"
+#include "trapezoid.h"
+#include "rhombus.h"
+#include "parallel.h"
+#include "collision.h"
+#include "covered_area.h"
+#include "edit_journal.h"
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+    const size_t PARALLEL_BLOCK = 4096;
+
+    // Владеет ли массив объектом единолично. Счётчик владельцев shared_ptr - и
+    // есть признак владения, но use_count() читает его relaxed: увидев 1, мы
+    // ещё не видим чтений объекта в потоке, только что отпустившем свою копию
+    // (фоновая контрольная точка), и запись на месте с ними гонится. Копия и её
+    // уничтожение - acq_rel-операции над тем же счётчиком: они захватывают
+    // освобождение прежнего владельца, и всё, что он делал с объектом, видно.
+    template <typename T>
+    bool exclusivelyOwned(const std::shared_ptr<T>& owner) {
+        if (owner.use_count() != 1) {
+            return false;
+        }
+        std::shared_ptr<T> handshake = owner;
+        handshake.reset();
+        return true;
+    }
+}
+
+const size_t FigureArray::CHUNK_SHIFT;
+const size_t FigureArray::CHUNK_SIZE;
+
+FigureArray::Chunk& FigureArray::mutableChunk(size_t chunk) {
+    std::shared_ptr<Chunk>& shared = chunks[chunk];
+    if (!exclusivelyOwned(shared)) {
+        auto copy = std::make_shared<Chunk>();
+        copy->reserve(CHUNK_SIZE);
+        copy->assign(shared->begin(), shared->end());
+        shared = copy;
+    }
+    return *shared;
+}
+
+Figure& FigureArray::mutableFigure(size_t index) {
+    Entry& entry = mutableChunk(index >> CHUNK_SHIFT)[index & (CHUNK_SIZE - 1)];
+    if (!entry.writable || !exclusivelyOwned(entry.figure)) {
+        std::shared_ptr<Figure> copy = entry.figure->clone();
+        entry = Entry(copy, true);
+        return *copy;
+    }
+    // Единственный владелец - массив, а фигуру он сам создал неконстантной.
+    return const_cast<Figure&>(*entry.figure);
+}
+
+void FigureArray::addFigure(std::shared_ptr<const Figure> fig) {
+    if (count == chunks.size() * CHUNK_SIZE) {
+        chunks.push_back(std::make_shared<Chunk>());
+        chunks.back()->reserve(CHUNK_SIZE);
+    }
+    mutableChunk(chunks.size() - 1).push_back(std::move(fig));
+    ++count;
+}
+
+void FigureArray::insertFigure(size_t index, std::shared_ptr<const Figure> fig) {
+    if (index > count) {
+        throw std::out_of_range("Figure index out of range");
+    }
+    if (index == count) {
+        addFigure(std::move(fig));
+        return;
+    }
+    // Последний элемент каждого блока переходит в начало следующего.
+    Entry carry(std::move(fig));
+    size_t offset = index & (CHUNK_SIZE - 1);
+    for (size_t c = index >> CHUNK_SHIFT; c < chunks.size() && carry.figure; ++c) {
+        Chunk& chunk = mutableChunk(c);
+        chunk.insert(chunk.begin() + offset, std::move(carry));
+        carry = Entry();
+        if (chunk.size() > CHUNK_SIZE) {
+            carry = std::move(chunk.back());
+            chunk.pop_back();
+        }
+        offset = 0;
+    }
+    if (carry.figure) {
+        chunks.push_back(std::make_shared<Chunk>());
+        chunks.back()->reserve(CHUNK_SIZE);
+        chunks.back()->push_back(std::move(carry));
+    }
+    ++count;
+}
+
+void FigureArray::removeFigure(size_t index) {
+    if (index >= count) {
+        return;
+    }
+    // Первый элемент каждого следующего блока переходит в конец предыдущего.
+    size_t offset = index & (CHUNK_SIZE - 1);
+    for (size_t c = index >> CHUNK_SHIFT; c < chunks.size(); ++c) {
+        Chunk& chunk = mutableChunk(c);
+        chunk.erase(chunk.begin() + offset);
+        if (c + 1 < chunks.size()) {
+            chunk.push_back((*chunks[c + 1])[0]);
+        }
+        offset = 0;
+    }
+    --count;
+    if (chunks.back()->empty()) {
+        chunks.pop_back();
+    }
+}
+
+void FigureArray::setVertex(size_t index, size_t vertex, const Point& p) {
+    at(index);
+    mutableFigure(index).setVertex(vertex, p);
+}
+
+void FigureArray::replaceFigure(size_t index, std::shared_ptr<const Figure> fig) {
+    at(index);
+    mutableChunk(index >> CHUNK_SHIFT)[index & (CHUNK_SIZE - 1)] = std::move(fig);
+}
+
+void FigureArray::printAll() const {
+    std::cout << "\n= All Figures =" << std::endl;
+    for (size_t i = 0; i < count; ++i) {
+        std::cout << "Figure " << i << ": " << *slot(i) << std::endl;
+        Point center = slot(i)->geometricCenter();
+        double area = slot(i)->area();
+        std::cout << "  Centre: (" << std::fixed << std::setprecision(2) << center.x
+                  << ", " << center.y << "), Area: " << area << std::endl;
+    }
+}
+
+double FigureArray::totalArea() const {
+    double total = 0;
+    for (const auto& fig : *this) {
+        total += fig->area();
+    }
+    return total;
+}
+
+double FigureArray::coveredArea(bool parallel) const {
+    return Coverage::unionArea(Collision::snapshot(*this), parallel);
+}
+
+const std::shared_ptr<const Figure>& FigureArray::at(size_t index) const {
+    if (index >= count) {
+        throw std::out_of_range("Figure index out of range");
+    }
+    return slot(index);
+}
+
+std::vector<FigureMetrics> FigureArray::metrics() const {
+    std::vector<FigureMetrics> result(count);
+    Parallel::forBlocks(count, PARALLEL_BLOCK, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            result[i] = FigureMetrics::of(*slot(i));
+        }
+    });
+    return result;
+}
+
+void FigureArray::transformAll(const AffineTransform& m) {
+    transformFigures(m, nullptr);
+}
+
+void FigureArray::transformAll(const AffineTransform& m, std::vector<FigureMetrics>& metrics) {
+    if (metrics.size() != count) {
+        throw std::invalid_argument("Metrics do not match the figure array");
+    }
+    transformFigures(m, &metrics);
+}
+
+void FigureArray::transformFigures(const AffineTransform& m, std::vector<FigureMetrics>* metrics) {
+    if (!m.isInvertible()) {
+        throw std::runtime_error("Degenerate transform cannot be applied to figures");
+    }
+    // Фигуры, преобразование которых может не удаться, сначала преобразуются в
+    // копиях; исключение из этого прохода оставляет массив прежним. Остальные
+    // после этого преобразуются на месте - с ними ошибиться уже нечему.
+    std::vector<std::vector<std::pair<size_t, std::shared_ptr<Figure>>>> staged(
+        Parallel::workerCount(count, PARALLEL_BLOCK));
+    Parallel::forBlocks(count, PARALLEL_BLOCK, [&](size_t worker, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (slot(i)->transformMayFail(m)) {
+                std::shared_ptr<Figure> fig = slot(i)->clone();
+                fig->transform(m);
+                staged[worker].emplace_back(i, std::move(fig));
+            }
+        }
+    });
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        mutableChunk(c);
+    }
+    Parallel::forBlocks(count, PARALLEL_BLOCK, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            Entry& entry = (*chunks[i >> CHUNK_SHIFT])[i & (CHUNK_SIZE - 1)];
+            if (entry.figure->transformMayFail(m)) {
+                continue;
+            }
+            Figure* fig;
+            if (entry.writable && exclusivelyOwned(entry.figure)) {
+                fig = const_cast<Figure*>(entry.figure.get());
+            } else {
+                std::shared_ptr<Figure> copy = entry.figure->clone();
+                fig = copy.get();
+                entry = Entry(std::move(copy), true);
+            }
+            fig->transform(m);
+            if (metrics) {
+                (*metrics)[i].update(m, *fig);
+            }
+        }
+    });
+    for (auto& figures : staged) {
+        for (auto& item : figures) {
+            if (metrics) {
+                (*metrics)[item.first].update(m, *item.second);
+            }
+            Entry& entry = (*chunks[item.first >> CHUNK_SHIFT])[item.first & (CHUNK_SIZE - 1)];
+            entry = Entry(std::move(item.second), true);
+        }
+    }
+}
+
+void FigureArray::demonstrateOperations() {
+    if (count == 0) {
+        std::cout << "No figures available for demonstration!" << std::endl;
+        return;
+    }
+    std::cout << "\n= Demonstration =" << std::endl;
+    std::cout << "Available figures:" << std::endl;
+    for (size_t i = 0; i < count; ++i) {
+        std::cout << "[" << i << "] " << slot(i)->typeName() << ": " << *slot(i) << std::endl;
+    }
+    std::cout << "\n1. COPY:" << std::endl;
+    std::cout << "Enter index of figure to copy (0-" << count-1 << "): ";
+    size_t copy_index;
+    std::cin >> copy_index;
+    if (copy_index >= count) {
+        std::cout << "Invalid index! Using first figure." << std::endl;
+        copy_index = 0;
+    }
+    auto original = slot(copy_index);
+    auto copy = original->clone();
+    std::cout << "Original: " << *original << std::endl;
+    std::cout << "Copy: " << *copy << std::endl;
+    std::cout << "Are equal: " << (*original == *copy ? "true" : "false") << std::endl;
+    std::cout << "\n2. MOVE:" << std::endl;
+    if (count >= 2) {
+        std::cout << "Enter source index (0-" << count-1 << "): ";
+        size_t src_index;
+        std::cin >> src_index;
+        std::cout << "Enter destination index (0-" << count-1 << "): ";
+        size_t dest_index;
+        std::cin >> dest_index;
+        if (src_index >= count || dest_index >= count) {
+            std::cout << "Invalid indexes! Using automatic demonstration." << std::endl;
+            Trapezoid temp1(Point(0,0), Point(5,0), Point(4,3), Point(1,3));
+            Trapezoid temp2(Point(1,1), Point(6,1), Point(5,4), Point(2,4));
+            std::cout << "Temp1 before move: " << temp1 << std::endl;
+            std::cout << "Temp2 before move: " << temp2 << std::endl;
+            temp2 = std::move(temp1);
+            std::cout << "After move:" << std::endl;
+            std::cout << "Temp1: " << temp1 << std::endl;
+            std::cout << "Temp2: " << temp2 << std::endl;
+        } else if (std::strcmp(slot(src_index)->typeName(), slot(dest_index)->typeName()) != 0) {
+            std::cout << "Cant move different figure types! Using temporary objs" << std::endl;
+            Rhombus temp1(Point(0,0), Point(2,3), Point(4,0), Point(2,-3));
+            Rhombus temp2(Point(1,1), Point(3,4), Point(5,1), Point(3,-2));
+            std::cout << "Temp1 before move: " << temp1 << std::endl;
+            std::cout << "Temp2 before move: " << temp2 << std::endl;
+            temp2 = std::move(temp1);
+            std::cout << "After move:" << std::endl;
+            std::cout << "Temp1: " << temp1 << std::endl;
+            std::cout << "Temp2: " << temp2 << std::endl;
+        } else {
+            // Перенос фигуры на место destination; восстановление - отменой в журнале, без копий фигур.
+            EditJournal journal(*this);
+            std::cout << "Before move:" << std::endl;
+            std::cout << "Source: " << *slot(src_index) << std::endl;
+            std::cout << "Destination: " << *slot(dest_index) << std::endl;
+            journal.moveFigure(src_index, dest_index);
+            std::cout << "After move:" << std::endl;
+            std::cout << "Source: " << *slot(src_index) << std::endl;
+            std::cout << "Destination: " << *slot(dest_index) << std::endl;
+            journal.undo();
+            std::cout << "After restoration:" << std::endl;
+            std::cout << "Source: " << *slot(src_index) << std::endl;
+            std::cout << "Destination: " << *slot(dest_index) << std::endl;
+        }
+    } else {
+        std::cout << "Need at least 2 figures for move operation!" << std::endl;
+    }
+    std::cout << "\n3. COMPARE:" << std::endl;
+    if (count >= 2) {
+        std::cout << "Enter first figure index (0-" << count-1 << "): ";
+        size_t comp_index1;
+        std::cin >> comp_index1;
+        std::cout << "Enter second figure index (0-" << count-1 << "): ";
+        size_t comp_index2;
+        std::cin >> comp_index2;
+        if (comp_index1 >= count || comp_index2 >= count) {
+            std::cout << "Invalid indexes! Using first 2 figs" << std::endl;
+            comp_index1 = 0;
+            comp_index2 = 1;
+        }
+        auto fig1 = slot(comp_index1);
+        auto fig2 = slot(comp_index2);
+        std::cout << "Figure 1 (" << fig1->typeName() << "): " << *fig1 << std::endl;
+        std::cout << "Figure 2 (" << fig2->typeName() << "): " << *fig2 << std::endl;
+        std::cout << "Figure 1 == Figure 2: " << (*fig1 == *fig2 ? "true" : "false") << std::endl;
+        std::cout << "Figure 1 != Figure 2: " << (*fig1 != *fig2 ? "true" : "false") << std::endl;
+    } else {
+        std::cout << "Need at least 2 figures for comparison!" << std::endl;
+    }
+}
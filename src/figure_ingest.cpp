@@ -0,0 +1,108 @@
+#include "figure_ingest.h"
+#include <stdexcept>
+
+const size_t FigureIngest::DEFAULT_BATCH;
+
+FigureIngest::Producer::Producer(FigureIngest& ingest, size_t batchSize)
+    : ingest(&ingest), batch(new Batch()), batchSize(batchSize == 0 ? 1 : batchSize) {
+    batch->items.reserve(this->batchSize);
+    ingest.producers.fetch_add(1, std::memory_order_relaxed);
+}
+
+FigureIngest::Producer::Producer(Producer&& other) noexcept
+    : ingest(other.ingest), batch(std::move(other.batch)), batchSize(other.batchSize) {
+    other.ingest = nullptr;
+}
+
+FigureIngest::Producer::~Producer() {
+    if (ingest) {
+        flush();
+        ingest->producers.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+void FigureIngest::Producer::push(Item item) {
+    batch->items.push_back(std::move(item));
+    if (batch->items.size() >= batchSize) {
+        flush();
+    }
+}
+
+void FigureIngest::Producer::push(std::shared_ptr<const Figure> fig) {
+    if (ingest->ordered) {
+        throw std::logic_error("Ordered ingest needs sequence numbers");
+    }
+    push(Item{0, std::move(fig), 0});
+}
+
+void FigureIngest::Producer::push(uint64_t sequence, std::shared_ptr<const Figure> fig) {
+    push(Item{sequence, std::move(fig), 0});
+}
+
+void FigureIngest::Producer::flush() {
+    if (batch->items.empty()) {
+        return;
+    }
+    std::unique_ptr<Batch> next(new Batch());
+    next->items.reserve(batchSize);
+    ingest->publish(batch.release());
+    batch = std::move(next);
+}
+
+void FigureIngest::publish(Batch* batch) {
+    batch->next = head.load(std::memory_order_relaxed);
+    while (!head.compare_exchange_weak(batch->next, batch, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+}
+
+FigureIngest::~FigureIngest() {
+    Batch* batch = head.exchange(nullptr);
+    while (batch) {
+        Batch* next = batch->next;
+        delete batch;
+        batch = next;
+    }
+}
+
+size_t FigureIngest::drainInto(FigureArray& figures) {
+    // Стек хранит пакеты от новых к старым; разворот восстанавливает порядок публикации.
+    Batch* batch = head.exchange(nullptr, std::memory_order_acquire);
+    Batch* oldest = nullptr;
+    while (batch) {
+        Batch* next = batch->next;
+        batch->next = oldest;
+        oldest = batch;
+        batch = next;
+    }
+    size_t added = 0;
+    while (oldest) {
+        std::unique_ptr<Batch> current(oldest);
+        oldest = current->next;
+        for (Item& item : current->items) {
+            if (!ordered) {
+                figures.addFigure(std::move(item.figure));
+                ++added;
+            } else if (item.sequence == expected) {
+                figures.addFigure(std::move(item.figure));
+                ++expected;
+                ++added;
+            } else if (item.sequence < expected) {
+                ++stale;
+            } else {
+                item.arrival = arrivals++;
+                waiting.push(std::move(item));
+            }
+        }
+        while (!waiting.empty() && waiting.top().sequence <= expected) {
+            if (waiting.top().sequence == expected) {
+                figures.addFigure(waiting.top().figure);
+                ++expected;
+                ++added;
+            } else {
+                ++stale; // повтор номера, уже ждавшего в очереди
+            }
+            waiting.pop();
+        }
+    }
+    return added;
+}
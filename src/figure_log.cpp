@@ -0,0 +1,241 @@
+#include "figure_log.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+    const size_t FRAME_HEADER = 2 * sizeof(uint32_t);
+
+    [[noreturn]] void fail(const std::string& what, const std::string& path) {
+        throw std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+    }
+
+    uint32_t checksum(const unsigned char* data, size_t size) {
+        uint32_t hash = 2166136261u; // FNV-1a
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ data[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    template <typename T>
+    void put(std::vector<unsigned char>& out, const T& value) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    template <typename T>
+    bool get(const unsigned char*& in, const unsigned char* end, T& value) {
+        if (static_cast<size_t>(end - in) < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, in, sizeof(T));
+        in += sizeof(T);
+        return true;
+    }
+
+    void encode(const LogEntry& entry, std::vector<unsigned char>& out) {
+        size_t frame = out.size();
+        out.resize(frame + FRAME_HEADER);
+        put(out, entry.sequence);
+        put(out, static_cast<uint8_t>(entry.op));
+        switch (entry.op) {
+        case LogEntry::ADD:
+            put(out, entry.figure);
+            break;
+        case LogEntry::REMOVE:
+            put(out, entry.index);
+            break;
+        case LogEntry::SET_VERTEX:
+            put(out, entry.index);
+            put(out, entry.vertex);
+            put(out, entry.point.x);
+            put(out, entry.point.y);
+            break;
+        }
+        uint32_t size = static_cast<uint32_t>(out.size() - frame - FRAME_HEADER);
+        uint32_t sum = checksum(out.data() + frame + FRAME_HEADER, size);
+        std::memcpy(out.data() + frame, &size, sizeof(size));
+        std::memcpy(out.data() + frame + sizeof(size), &sum, sizeof(sum));
+    }
+
+    bool decode(const unsigned char* in, const unsigned char* end, LogEntry& entry) {
+        uint8_t op;
+        if (!get(in, end, entry.sequence) || !get(in, end, op)) {
+            return false;
+        }
+        entry.op = static_cast<LogEntry::Op>(op);
+        switch (entry.op) {
+        case LogEntry::ADD:
+            return get(in, end, entry.figure) && in == end;
+        case LogEntry::REMOVE:
+            return get(in, end, entry.index) && in == end;
+        case LogEntry::SET_VERTEX:
+            return get(in, end, entry.index) && get(in, end, entry.vertex) &&
+                   get(in, end, entry.point.x) && get(in, end, entry.point.y) && in == end;
+        }
+        return false;
+    }
+
+    void writeAll(int fd, const unsigned char* data, size_t size, const std::string& path) {
+        while (size > 0) {
+            ssize_t written = ::write(fd, data, size);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                fail("Cannot write", path);
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+    }
+}
+
+FigureLog::FigureLog(const std::string& path, uint64_t after, const std::function<void(const LogEntry&)>& replay)
+    : path(path), nextSequence(after + 1), durableSequence(after) {
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+        fail("Cannot open", path);
+    }
+    std::vector<unsigned char> data;
+    unsigned char chunk[1 << 16];
+    for (;;) {
+        ssize_t got = ::read(fd, chunk, sizeof(chunk));
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            int error = errno;
+            ::close(fd);
+            errno = error;
+            fail("Cannot read", path);
+        }
+        if (got == 0) {
+            break;
+        }
+        data.insert(data.end(), chunk, chunk + got);
+    }
+
+    size_t valid = 0;
+    try {
+        while (data.size() - valid >= FRAME_HEADER) {
+            uint32_t size, sum;
+            std::memcpy(&size, data.data() + valid, sizeof(size));
+            std::memcpy(&sum, data.data() + valid + sizeof(size), sizeof(sum));
+            const unsigned char* payload = data.data() + valid + FRAME_HEADER;
+            if (size > data.size() - valid - FRAME_HEADER || checksum(payload, size) != sum) {
+                break;
+            }
+            LogEntry entry;
+            if (!decode(payload, payload + size, entry)) {
+                break;
+            }
+            if (entry.sequence > after) {
+                replay(entry);
+            }
+            if (entry.sequence >= nextSequence) {
+                nextSequence = entry.sequence + 1;
+            }
+            valid += FRAME_HEADER + size;
+        }
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    durableSequence = nextSequence - 1;
+    // Недописанная при сбое запись не должна оказаться перед новыми.
+    if (valid != data.size() && (::ftruncate(fd, static_cast<off_t>(valid)) != 0 || ::fdatasync(fd) != 0)) {
+        int error = errno;
+        ::close(fd);
+        errno = error;
+        fail("Cannot truncate", path);
+    }
+    fileBytes = valid;
+}
+
+FigureLog::~FigureLog() {
+    try {
+        commit();
+    } catch (...) {
+    }
+    ::close(fd);
+}
+
+uint64_t FigureLog::append(LogEntry entry) {
+    std::lock_guard<std::mutex> lock(mutex);
+    entry.sequence = nextSequence++;
+    encode(entry, pending);
+    return entry.sequence;
+}
+
+void FigureLog::commit(uint64_t sequence) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (durableSequence < sequence) {
+        if (!failure.empty()) {
+            throw std::runtime_error(failure);
+        }
+        if (flushing) {
+            flushed.wait(lock);
+            continue;
+        }
+        // Этот поток сбрасывает всё накопленное, в том числе записи других потоков.
+        std::vector<unsigned char> batch;
+        batch.swap(pending);
+        uint64_t target = nextSequence - 1;
+        flushing = true;
+        lock.unlock();
+        std::string error;
+        try {
+            writeAll(fd, batch.data(), batch.size(), path);
+            if (::fdatasync(fd) != 0) {
+                fail("Cannot sync", path);
+            }
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        lock.lock();
+        flushing = false;
+        if (error.empty()) {
+            durableSequence = target;
+            fileBytes += batch.size();
+        } else {
+            failure = error; // что попало в файл - неизвестно; журнал дальше не пишется
+        }
+        flushed.notify_all();
+    }
+}
+
+void FigureLog::commit() {
+    uint64_t last;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        last = nextSequence - 1;
+    }
+    commit(last);
+}
+
+void FigureLog::reset() {
+    commit();
+    std::unique_lock<std::mutex> lock(mutex);
+    while (flushing) {
+        flushed.wait(lock);
+    }
+    if (::ftruncate(fd, 0) != 0 || ::fdatasync(fd) != 0) {
+        fail("Cannot truncate", path);
+    }
+    pending.clear();
+    fileBytes = 0;
+}
+
+uint64_t FigureLog::lastSequence() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return nextSequence - 1;
+}
+
+size_t FigureLog::size() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return fileBytes + pending.size();
+}
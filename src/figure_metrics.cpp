@@ -0,0 +1,31 @@
+#include "figure_metrics.h"
+#include <algorithm>
+#include <cmath>
+
+FigureMetrics FigureMetrics::of(const Figure& fig) {
+    FigureMetrics result;
+    result.area = fig.area();
+    result.center = fig.geometricCenter();
+    result.perimeter = GeometryUtils::perimeter(fig);
+    result.box = GeometryUtils::boundingBox(fig);
+    return result;
+}
+
+void FigureMetrics::update(const AffineTransform& m, const Figure& transformed) {
+    double det = m.determinant();
+    area *= std::abs(det);
+    center = m.apply(center);
+    if (m.isSimilarity()) {
+        perimeter *= std::sqrt(std::abs(det));
+    } else {
+        perimeter = GeometryUtils::perimeter(transformed);
+    }
+    if (m.isAxisAligned()) {
+        Point low = m.apply(Point(box.minX, box.minY));
+        Point high = m.apply(Point(box.maxX, box.maxY));
+        box = BoundingBox(std::min(low.x, high.x), std::min(low.y, high.y),
+                          std::max(low.x, high.x), std::max(low.y, high.y));
+    } else {
+        box = GeometryUtils::boundingBox(transformed);
+    }
+}
@@ -0,0 +1,91 @@
+#include "figure_order.h"
+#include "parallel.h"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+    const size_t KEY_BLOCK = 4096;
+    const size_t SORT_BLOCK = 1 << 15;
+
+    typedef std::pair<double, size_t> KeyedIndex;
+
+    struct KeyOrder {
+        bool descending;
+        bool operator()(const KeyedIndex& l, const KeyedIndex& r) const {
+            if (l.first != r.first) {
+                return descending ? l.first > r.first : l.first < r.first;
+            }
+            return l.second < r.second;
+        }
+    };
+}
+
+namespace FigureKeys {
+    double of(const Figure& fig, FigureKey key) {
+        switch (key) {
+            case FigureKey::Area:
+                return fig.area();
+            case FigureKey::Perimeter:
+                return GeometryUtils::perimeter(fig);
+            case FigureKey::CenterX:
+                return fig.geometricCenter().x;
+            case FigureKey::CenterY:
+                return fig.geometricCenter().y;
+        }
+        throw std::invalid_argument("Unknown figure key");
+    }
+
+    std::vector<double> extract(const FigureArray& figures, FigureKey key) {
+        std::vector<double> keys(figures.size());
+        Parallel::forBlocks(figures.size(), KEY_BLOCK, [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                keys[i] = of(*figures.at(i), key);
+            }
+        });
+        return keys;
+    }
+
+    std::vector<size_t> sortedPermutation(const std::vector<double>& keys, bool descending) {
+        std::vector<KeyedIndex> items(keys.size());
+        for (size_t i = 0; i < keys.size(); ++i) {
+            items[i] = KeyedIndex(keys[i], i);
+        }
+        KeyOrder order = {descending};
+        size_t workers = Parallel::workerCount(items.size(), SORT_BLOCK);
+        size_t step = (items.size() + workers - 1) / std::max<size_t>(workers, 1);
+        Parallel::forBlocks(items.size(), SORT_BLOCK, [&](size_t, size_t begin, size_t end) {
+            std::sort(items.begin() + begin, items.begin() + end, order);
+        });
+        // попарное слияние отсортированных блоков, слияния одного шага - параллельно
+        for (size_t width = step; width < items.size(); width *= 2) {
+            size_t merges = (items.size() + 2 * width - 1) / (2 * width);
+            Parallel::forBlocks(merges, 1, [&](size_t, size_t begin, size_t end) {
+                for (size_t m = begin; m < end; ++m) {
+                    size_t first = m * 2 * width;
+                    size_t middle = std::min(items.size(), first + width);
+                    size_t last = std::min(items.size(), first + 2 * width);
+                    std::inplace_merge(items.begin() + first, items.begin() + middle, items.begin() + last, order);
+                }
+            });
+        }
+        std::vector<size_t> permutation(items.size());
+        for (size_t i = 0; i < items.size(); ++i) {
+            permutation[i] = items[i].second;
+        }
+        return permutation;
+    }
+}
+
+OrderedView::OrderedView(const FigureArray& figures, FigureKey key, bool descending)
+    : figures(&figures), keys(FigureKeys::extract(figures, key)) {
+    permutation = FigureKeys::sortedPermutation(keys, descending);
+}
+
+OrderedView::OrderedView(const FigureArray& figures, const std::vector<double>& keys, bool descending)
+    : figures(&figures), keys(keys) {
+    if (keys.size() != figures.size()) {
+        throw std::invalid_argument("Keys do not match the figure array");
+    }
+    permutation = FigureKeys::sortedPermutation(keys, descending);
+}
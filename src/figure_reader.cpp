@@ -0,0 +1,30 @@
+#include "figure_reader.h"
+#include "trapezoid.h"
+#include "rhombus.h"
+#include "pentagon.h"
+#include <stdexcept>
+
+std::shared_ptr<Figure> FigureReader::create(const std::string& typeName) {
+    if (typeName == "Trapezoid") {
+        return std::make_shared<Trapezoid>();
+    }
+    if (typeName == "Rhombus") {
+        return std::make_shared<Rhombus>();
+    }
+    if (typeName == "Pentagon") {
+        return std::make_shared<Pentagon>();
+    }
+    throw std::runtime_error("Unknown figure type: " + typeName);
+}
+
+bool FigureReader::next(std::shared_ptr<Figure>& figure) {
+    std::string typeName;
+    if (!(is >> typeName)) {
+        return false;
+    }
+    std::shared_ptr<Figure> result = create(typeName);
+    is >> *result;
+    figure = result;
+    ++count;
+    return true;
+}
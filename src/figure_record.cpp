@@ -0,0 +1,94 @@
+#include "figure_record.h"
+#include "trapezoid.h"
+#include "rhombus.h"
+#include "pentagon.h"
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable<FigureRecord>::value, "FigureRecord is stored as raw bytes");
+static_assert(sizeof(FigureRecord) == 8 + FigureRecord::MAX_VERTICES * sizeof(Point), "FigureRecord must be packed");
+
+double FigureRecord::area() const {
+    double sum = 0;
+    for (uint32_t i = 0; i < vertexCount; ++i) {
+        uint32_t j = (i + 1) % vertexCount;
+        sum += vertices[i].x * vertices[j].y - vertices[j].x * vertices[i].y;
+    }
+    return std::abs(sum) / 2.0;
+}
+
+BoundingBox FigureRecord::bounds() const {
+    BoundingBox box;
+    for (uint32_t i = 0; i < vertexCount; ++i) {
+        box.expand(vertices[i]);
+    }
+    return box;
+}
+
+namespace FigureRecords {
+    const char* typeName(uint32_t type) {
+        switch (type) {
+        case TRAPEZOID: return "Trapezoid";
+        case RHOMBUS: return "Rhombus";
+        case PENTAGON: return "Pentagon";
+        }
+        return nullptr;
+    }
+
+    FigureRecord encode(const Figure& fig) {
+        FigureRecord record{};
+        const char* name = fig.typeName();
+        for (uint32_t type = TRAPEZOID; type <= PENTAGON; ++type) {
+            if (std::strcmp(name, typeName(type)) == 0) {
+                record.type = type;
+            }
+        }
+        if (record.type == 0 || fig.vertexCount() > FigureRecord::MAX_VERTICES) {
+            throw std::invalid_argument(std::string("Cannot store figure of type ") + name);
+        }
+        record.check = static_cast<uint16_t>(fig.checkState());
+        record.vertexCount = static_cast<uint32_t>(fig.vertexCount());
+        for (uint32_t i = 0; i < record.vertexCount; ++i) {
+            record.vertices[i] = fig.getVertex(i);
+        }
+        return record;
+    }
+
+    std::shared_ptr<Figure> decode(const FigureRecord& record) {
+        const Point* v = record.vertices;
+        if (record.type == TRAPEZOID && record.vertexCount == 4) {
+            return std::make_shared<Trapezoid>(v[0], v[1], v[2], v[3]);
+        }
+        if (record.type == RHOMBUS && record.vertexCount == 4) {
+            return std::make_shared<Rhombus>(v[0], v[1], v[2], v[3]);
+        }
+        if (record.type == PENTAGON && record.vertexCount == 5) {
+            return std::make_shared<Pentagon>(v[0], v[1], v[2], v[3], v[4]);
+        }
+        throw std::runtime_error("Corrupted figure record: type " + std::to_string(record.type) +
+                                 ", " + std::to_string(record.vertexCount) + " vertices");
+    }
+
+    std::shared_ptr<Figure> restore(const FigureRecord& record) {
+        std::shared_ptr<Figure> fig;
+        if (record.type == TRAPEZOID && record.vertexCount == 4) {
+            fig = std::make_shared<Trapezoid>();
+        } else if (record.type == RHOMBUS && record.vertexCount == 4) {
+            fig = std::make_shared<Rhombus>();
+        } else if (record.type == PENTAGON && record.vertexCount == 5) {
+            fig = std::make_shared<Pentagon>();
+        }
+        if (!fig || record.check > static_cast<uint16_t>(Figure::CheckState::EMPTY)) {
+            throw std::runtime_error("Corrupted figure record: type " + std::to_string(record.type) +
+                                     ", " + std::to_string(record.vertexCount) + " vertices, state " +
+                                     std::to_string(record.check));
+        }
+        for (uint32_t i = 0; i < record.vertexCount; ++i) {
+            fig->setVertex(i, record.vertices[i]);
+        }
+        fig->restoreCheckState(static_cast<Figure::CheckState>(record.check));
+        return fig;
+    }
+}
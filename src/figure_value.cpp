@@ -0,0 +1,50 @@
+#include "figure_value.h"
+#include "trapezoid.h"
+#include "rhombus.h"
+#include "pentagon.h"
+
+static_assert(FigureValue::fitsInline<Trapezoid>::value, "Trapezoid must be stored inline");
+static_assert(FigureValue::fitsInline<Rhombus>::value, "Rhombus must be stored inline");
+static_assert(FigureValue::fitsInline<Pentagon>::value, "Pentagon must be stored inline");
+
+FigureValue::FigureValue(const FigureValue& other) : ops(nullptr) {
+    if (other.ops) {
+        other.ops->copy(other.storage, storage);
+        ops = other.ops;
+    }
+}
+
+FigureValue::FigureValue(FigureValue&& other) noexcept : ops(nullptr) {
+    if (other.ops) {
+        other.ops->move(other.storage, storage);
+        ops = other.ops;
+        other.reset();
+    }
+}
+
+FigureValue& FigureValue::operator=(const FigureValue& other) {
+    if (this != &other) {
+        FigureValue copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+FigureValue& FigureValue::operator=(FigureValue&& other) noexcept {
+    if (this != &other) {
+        reset();
+        if (other.ops) {
+            other.ops->move(other.storage, storage);
+            ops = other.ops;
+            other.reset();
+        }
+    }
+    return *this;
+}
+
+void FigureValue::reset() noexcept {
+    if (ops) {
+        ops->destroy(storage);
+        ops = nullptr;
+    }
+}
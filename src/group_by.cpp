@@ -0,0 +1,87 @@
+#include "group_by.h"
+#include "parallel.h"
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <typeindex>
+
+namespace {
+    const size_t GROUP_BLOCK = 8192;
+
+    // Внутри прохода тип определяется по typeid - без сравнения строк.
+    typedef std::pair<std::type_index, int> FastKey;
+
+    struct Partial {
+        std::map<FastKey, GroupStats> groups;
+        std::map<std::type_index, std::string> names;
+    };
+}
+
+bool GroupKey::operator<(const GroupKey& other) const {
+    return type < other.type || (type == other.type && tag < other.tag);
+}
+
+GroupStats::GroupStats()
+    : minArea(std::numeric_limits<double>::infinity()), maxArea(-std::numeric_limits<double>::infinity()) {}
+
+void GroupStats::merge(const GroupStats& other) {
+    count += other.count;
+    totalArea += other.totalArea;
+    minArea = std::min(minArea, other.minArea);
+    maxArea = std::max(maxArea, other.maxArea);
+    totalPerimeter += other.totalPerimeter;
+    extent.expand(other.extent);
+}
+
+const GroupStats* GroupByResult::find(const std::string& type, int tag) const {
+    GroupKey key;
+    key.type = type;
+    key.tag = tag;
+    auto it = std::lower_bound(rows.begin(), rows.end(), key, [](const Row& row, const GroupKey& k) {
+        return row.first < k;
+    });
+    return it != rows.end() && it->first == key ? &it->second : nullptr;
+}
+
+namespace GroupBy {
+    GroupByResult byType(const FigureArray& figures, unsigned aggregates, const FigureTagger& tagger) {
+        std::vector<Partial> partial(Parallel::workerCount(figures.size(), GROUP_BLOCK));
+        Parallel::forBlocks(figures.size(), GROUP_BLOCK, [&](size_t worker, size_t begin, size_t end) {
+            Partial& local = partial[worker];
+            for (size_t i = begin; i < end; ++i) {
+                const Figure& fig = *figures.at(i);
+                std::type_index type(typeid(fig));
+                FastKey key(type, tagger ? tagger(i, fig) : 0);
+                GroupStats& stats = local.groups[key];
+                if (stats.count == 0 && local.names.find(type) == local.names.end()) {
+                    local.names.insert(std::make_pair(type, std::string(fig.typeName())));
+                }
+                ++stats.count;
+                if (aggregates & Aggregate::AREA) {
+                    double area = fig.area();
+                    stats.totalArea += area;
+                    stats.minArea = std::min(stats.minArea, area);
+                    stats.maxArea = std::max(stats.maxArea, area);
+                }
+                if (aggregates & Aggregate::PERIMETER) {
+                    stats.totalPerimeter += GeometryUtils::perimeter(fig);
+                }
+                if (aggregates & Aggregate::EXTENT) {
+                    for (size_t v = 0; v < fig.vertexCount(); ++v) {
+                        stats.extent.expand(fig.getVertex(v));
+                    }
+                }
+            }
+        });
+        std::map<GroupKey, GroupStats> merged;
+        for (const Partial& local : partial) {
+            for (const auto& item : local.groups) {
+                GroupKey key;
+                key.type = local.names.at(item.first.first);
+                key.tag = item.first.second;
+                merged[key].merge(item.second);
+            }
+        }
+        return GroupByResult(std::vector<GroupByResult::Row>(merged.begin(), merged.end()));
+    }
+}
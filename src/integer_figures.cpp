@@ -0,0 +1,272 @@
+#include "integer_figures.h"
+#include "trapezoid.h"
+#include "rhombus.h"
+#include "pentagon.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace IntegerGeometry {
+    std::string toString(Wide value) {
+        if (value == 0) {
+            return "0";
+        }
+        bool negative = value < 0;
+        std::string digits;
+        while (value != 0) {
+            int digit = static_cast<int>(value % 10);
+            digits.push_back(static_cast<char>('0' + (digit < 0 ? -digit : digit)));
+            value /= 10;
+        }
+        if (negative) {
+            digits.push_back('-');
+        }
+        std::reverse(digits.begin(), digits.end());
+        return digits;
+    }
+}
+
+template <typename Derived, typename T, size_t N>
+void IntPolygon<Derived, T, N>::checkRange() const {
+    for (size_t i = 0; i < N; ++i) {
+        if (!IntegerGeometry::inRange(vertices[i])) {
+            throw std::out_of_range("Vertex coordinate exceeds exact arithmetic range");
+        }
+    }
+}
+
+template <typename Derived, typename T, size_t N>
+void IntPolygon<Derived, T, N>::validateState() const {
+    if (!validState) {
+        throw std::runtime_error(std::string(name()) + " is in invalid state");
+    }
+    checkRange();
+}
+
+template <typename Derived, typename T, size_t N>
+IntPoint<T> IntPolygon<Derived, T, N>::getVertex(size_t index) const {
+    if (index >= N) {
+        throw std::out_of_range("Vertex index out of range");
+    }
+    return vertices[index];
+}
+
+template <typename Derived, typename T, size_t N>
+void IntPolygon<Derived, T, N>::setVertex(size_t index, const IntPoint<T>& p) {
+    if (index >= N) {
+        throw std::out_of_range("Vertex index out of range");
+    }
+    vertices[index] = p;
+    validState = true;
+}
+
+template <typename Derived, typename T, size_t N>
+void IntPolygon<Derived, T, N>::clearVertices() {
+    for (size_t i = 0; i < N; ++i) {
+        vertices[i] = IntPoint<T>(0, 0);
+    }
+    validState = false;
+}
+
+template <typename Derived, typename T, size_t N>
+IntegerGeometry::Wide IntPolygon<Derived, T, N>::twiceArea() const {
+    static_cast<const Derived*>(this)->validate();
+    IntegerGeometry::Wide area = 0;
+    for (size_t i = 1; i + 1 < N; ++i) {
+        area += IntegerGeometry::crossProduct(vertices[0], vertices[i], vertices[i + 1]);
+    }
+    return area < 0 ? -area : area;
+}
+
+template <typename Derived, typename T, size_t N>
+double IntPolygon<Derived, T, N>::area() const {
+    return static_cast<double>(twiceArea()) / 2.0;
+}
+
+template <typename Derived, typename T, size_t N>
+Point IntPolygon<Derived, T, N>::geometricCenter() const {
+    static_cast<const Derived*>(this)->validate();
+    IntegerGeometry::Wide sum_x = 0, sum_y = 0;
+    for (size_t i = 0; i < N; ++i) {
+        sum_x += vertices[i].x;
+        sum_y += vertices[i].y;
+    }
+    return Point(static_cast<double>(sum_x) / N, static_cast<double>(sum_y) / N);
+}
+
+template <typename Derived, typename T, size_t N>
+void IntPolygon<Derived, T, N>::print(std::ostream& os) const {
+    if (!validState) {
+        os << name() << " (moved-from state)";
+        return;
+    }
+    os << name() << " vertices: ";
+    for (size_t i = 0; i < N; ++i) {
+        os << "(" << vertices[i].x << ", " << vertices[i].y << ") ";
+    }
+}
+
+template <typename Derived, typename T, size_t N>
+void IntPolygon<Derived, T, N>::read(std::istream& is) {
+    for (size_t i = 0; i < N; ++i) {
+        T x, y;
+        if (!(is >> x >> y)) {
+            throw std::runtime_error(std::string("Failed to read ") + name() + " vertices");
+        }
+        vertices[i] = IntPoint<T>(x, y);
+    }
+    validState = true;
+    static_cast<const Derived*>(this)->validate();
+}
+
+template <typename Derived, typename T, size_t N>
+bool IntPolygon<Derived, T, N>::operator==(const Derived& other) const {
+    const IntPolygon& base = other;
+    for (size_t i = 0; i < N; ++i) {
+        if (vertices[i] != base.vertices[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename T>
+const char* const IntTrapezoid<T>::NAME = "Trapezoid";
+
+template <typename T>
+IntTrapezoid<T>::IntTrapezoid(const IntPoint<T>& p1, const IntPoint<T>& p2, const IntPoint<T>& p3, const IntPoint<T>& p4) {
+    this->vertices[0] = p1;
+    this->vertices[1] = p2;
+    this->vertices[2] = p3;
+    this->vertices[3] = p4;
+    this->validState = true;
+    validate();
+}
+
+template <typename T>
+void IntTrapezoid<T>::validate() const {
+    this->validateState();
+    const IntPoint<T>* v = this->vertices;
+    int sign = 0;
+    for (int i = 0; i < 4; ++i) {
+        IntegerGeometry::Wide cross = IntegerGeometry::crossProduct(v[i], v[(i + 1) % 4], v[(i + 2) % 4]);
+        if (cross == 0) {
+            throw std::runtime_error("Invalid trapezoid: three consecutive points are collinear");
+        }
+        if (sign == 0) {
+            sign = (cross > 0) ? 1 : -1;
+        } else if ((cross > 0) != (sign > 0)) {
+            throw std::runtime_error("Invalid trapezoid: polygon is not convex");
+        }
+    }
+    int parallelCount = 0;
+    if (IntegerGeometry::areParallel(v[0], v[1], v[2], v[3])) {
+        parallelCount++;
+    }
+    if (IntegerGeometry::areParallel(v[1], v[2], v[3], v[0])) {
+        parallelCount++;
+    }
+    if (parallelCount != 1) {
+        throw std::runtime_error("Invalid trapezoid: must have exactly one pair of parallel sides");
+    }
+}
+
+template <typename T>
+std::shared_ptr<Figure> IntTrapezoid<T>::toFigure() const {
+    validate();
+    const IntPoint<T>* v = this->vertices;
+    return std::make_shared<Trapezoid>(v[0].toPoint(), v[1].toPoint(), v[2].toPoint(), v[3].toPoint());
+}
+
+template <typename T>
+const char* const IntRhombus<T>::NAME = "Rhombus";
+
+template <typename T>
+IntRhombus<T>::IntRhombus(const IntPoint<T>& p1, const IntPoint<T>& p2, const IntPoint<T>& p3, const IntPoint<T>& p4) {
+    this->vertices[0] = p1;
+    this->vertices[1] = p2;
+    this->vertices[2] = p3;
+    this->vertices[3] = p4;
+    this->validState = true;
+    validate();
+}
+
+template <typename T>
+void IntRhombus<T>::validate() const {
+    this->validateState();
+    const IntPoint<T>* v = this->vertices;
+    IntegerGeometry::Wide side1 = IntegerGeometry::squaredDistance(v[0], v[1]);
+    if (side1 != IntegerGeometry::squaredDistance(v[1], v[2]) ||
+        side1 != IntegerGeometry::squaredDistance(v[2], v[3]) ||
+        side1 != IntegerGeometry::squaredDistance(v[3], v[0])) {
+        throw std::runtime_error("Invalid rhombus: all sides must be equal");
+    }
+    if (IntegerGeometry::dotProduct(v[0], v[2], v[1], v[3]) != 0) {
+        throw std::runtime_error("Invalid rhombus: diagonals are not perpendicular");
+    }
+    for (int i = 0; i < 4; ++i) {
+        if (IntegerGeometry::areCollinear(v[i], v[(i + 1) % 4], v[(i + 2) % 4])) {
+            throw std::runtime_error("Invalid rhombus: three consecutive points are collinear");
+        }
+    }
+}
+
+template <typename T>
+std::shared_ptr<Figure> IntRhombus<T>::toFigure() const {
+    validate();
+    const IntPoint<T>* v = this->vertices;
+    return std::make_shared<Rhombus>(v[0].toPoint(), v[1].toPoint(), v[2].toPoint(), v[3].toPoint());
+}
+
+template <typename T>
+const char* const IntPentagon<T>::NAME = "Pentagon";
+
+template <typename T>
+IntPentagon<T>::IntPentagon(const IntPoint<T>& p1, const IntPoint<T>& p2, const IntPoint<T>& p3,
+                            const IntPoint<T>& p4, const IntPoint<T>& p5) {
+    this->vertices[0] = p1;
+    this->vertices[1] = p2;
+    this->vertices[2] = p3;
+    this->vertices[3] = p4;
+    this->vertices[4] = p5;
+    this->validState = true;
+    validate();
+}
+
+template <typename T>
+void IntPentagon<T>::validate() const {
+    this->validateState();
+    const IntPoint<T>* v = this->vertices;
+    int sign = 0;
+    for (int i = 0; i < 5; ++i) {
+        IntegerGeometry::Wide cross = IntegerGeometry::crossProduct(v[i], v[(i + 1) % 5], v[(i + 2) % 5]);
+        if (cross == 0) {
+            throw std::runtime_error("Invalid pentagon: three consecutive points are collinear");
+        }
+        if (sign == 0) {
+            sign = (cross > 0) ? 1 : -1;
+        } else if ((cross > 0) != (sign > 0)) {
+            throw std::runtime_error("Invalid pentagon: polygon is not convex");
+        }
+    }
+}
+
+template <typename T>
+std::shared_ptr<Figure> IntPentagon<T>::toFigure() const {
+    validate();
+    const IntPoint<T>* v = this->vertices;
+    return std::make_shared<Pentagon>(v[0].toPoint(), v[1].toPoint(), v[2].toPoint(),
+                                      v[3].toPoint(), v[4].toPoint());
+}
+
+template class IntPolygon<IntTrapezoid<int32_t>, int32_t, 4>;
+template class IntPolygon<IntTrapezoid<int64_t>, int64_t, 4>;
+template class IntPolygon<IntRhombus<int32_t>, int32_t, 4>;
+template class IntPolygon<IntRhombus<int64_t>, int64_t, 4>;
+template class IntPolygon<IntPentagon<int32_t>, int32_t, 5>;
+template class IntPolygon<IntPentagon<int64_t>, int64_t, 5>;
+template class IntTrapezoid<int32_t>;
+template class IntTrapezoid<int64_t>;
+template class IntRhombus<int32_t>;
+template class IntRhombus<int64_t>;
+template class IntPentagon<int32_t>;
+template class IntPentagon<int64_t>;
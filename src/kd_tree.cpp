@@ -0,0 +1,120 @@
+#include "kd_tree.h"
+#include "collision.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+    const size_t QUERY_BLOCK = 64;
+
+    double boxDistance(const BoundingBox& box, const Point& p) {
+        double dx = std::max(0.0, std::max(box.minX - p.x, p.x - box.maxX));
+        double dy = std::max(0.0, std::max(box.minY - p.y, p.y - box.maxY));
+        return std::sqrt(dx * dx + dy * dy);
+    }
+
+    // Куча с худшим из найденных соседей на вершине.
+    bool closer(const FigureNeighbor& a, const FigureNeighbor& b) {
+        return a.distance < b.distance || (a.distance == b.distance && a.index < b.index);
+    }
+}
+
+FigureKdTree::FigureKdTree(const FigureArray& figures) : FigureKdTree(Collision::snapshot(figures)) {}
+
+FigureKdTree::FigureKdTree(std::vector<ConvexPolygon> source) : polygons(std::move(source)) {
+    boxes.resize(polygons.size());
+    centers.resize(polygons.size());
+    for (size_t i = 0; i < polygons.size(); ++i) {
+        boxes[i] = polygons[i].bounds();
+        centers[i] = polygons[i].geometricCenter();
+    }
+    order.resize(polygons.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    if (!polygons.empty()) {
+        nodes.reserve(2 * polygons.size() / LEAF_SIZE + 1);
+        build(0, polygons.size());
+    }
+}
+
+size_t FigureKdTree::build(size_t begin, size_t end) {
+    size_t index = nodes.size();
+    nodes.push_back(Node());
+    BoundingBox box, spread;
+    for (size_t i = begin; i < end; ++i) {
+        box.expand(boxes[order[i]]);
+        spread.expand(centers[order[i]]);
+    }
+    nodes[index].box = box;
+    nodes[index].begin = begin;
+    nodes[index].end = end;
+    if (end - begin <= LEAF_SIZE) {
+        return index;
+    }
+    bool byX = spread.width() >= spread.height();
+    size_t middle = begin + (end - begin) / 2;
+    std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end, [&](size_t l, size_t r) {
+        return byX ? centers[l].x < centers[r].x : centers[l].y < centers[r].y;
+    });
+    size_t left = build(begin, middle);
+    size_t right = build(middle, end);
+    nodes[index].left = left;
+    nodes[index].right = right;
+    return index;
+}
+
+void FigureKdTree::search(size_t nodeIndex, const Point& p, size_t k, std::vector<FigureNeighbor>& heap) const {
+    const Node& node = nodes[nodeIndex];
+    if (node.left == NONE) {
+        for (size_t i = node.begin; i < node.end; ++i) {
+            size_t figure = order[i];
+            if (heap.size() == k && boxDistance(boxes[figure], p) > heap.front().distance) {
+                continue;
+            }
+            FigureNeighbor candidate = {figure, polygons[figure].distanceTo(p)};
+            if (heap.size() < k) {
+                heap.push_back(candidate);
+                std::push_heap(heap.begin(), heap.end(), closer);
+            } else if (closer(candidate, heap.front())) {
+                std::pop_heap(heap.begin(), heap.end(), closer);
+                heap.back() = candidate;
+                std::push_heap(heap.begin(), heap.end(), closer);
+            }
+        }
+        return;
+    }
+    size_t first = node.left, second = node.right;
+    double firstDistance = boxDistance(nodes[first].box, p);
+    double secondDistance = boxDistance(nodes[second].box, p);
+    if (secondDistance < firstDistance) {
+        std::swap(first, second);
+        std::swap(firstDistance, secondDistance);
+    }
+    if (heap.size() < k || firstDistance <= heap.front().distance) {
+        search(first, p, k, heap);
+    }
+    if (heap.size() < k || secondDistance <= heap.front().distance) {
+        search(second, p, k, heap);
+    }
+}
+
+std::vector<FigureNeighbor> FigureKdTree::nearest(const Point& p, size_t k) const {
+    std::vector<FigureNeighbor> heap;
+    if (k == 0 || nodes.empty()) {
+        return heap;
+    }
+    heap.reserve(std::min(k, size()));
+    search(0, p, k, heap);
+    std::sort_heap(heap.begin(), heap.end(), closer);
+    return heap;
+}
+
+std::vector<std::vector<FigureNeighbor>> FigureKdTree::nearestBatch(const std::vector<Point>& points, size_t k) const {
+    std::vector<std::vector<FigureNeighbor>> result(points.size());
+    Parallel::forBlocks(points.size(), QUERY_BLOCK, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            result[i] = nearest(points[i], k);
+        }
+    });
+    return result;
+}
@@ -0,0 +1,190 @@
+#include "mapped_store.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const uint32_t MappedFigureStore::VERSION;
+const size_t MappedFigureStore::HEADER_SIZE;
+
+namespace {
+    const char MAGIC[8] = {'F', 'I', 'G', 'S', 'T', 'O', 'R', 'E'};
+
+    [[noreturn]] void fail(const std::string& what, const std::string& path) {
+        throw std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+    }
+
+    size_t fileBytes(size_t capacity) {
+        return MappedFigureStore::HEADER_SIZE + capacity * sizeof(FigureRecord);
+    }
+}
+
+MappedFigureStore::MappedFigureStore(const std::string& path, int fd) : path(path), fd(fd) {}
+
+MappedFigureStore::MappedFigureStore(MappedFigureStore&& other) noexcept
+    : path(std::move(other.path)), fd(other.fd), base(other.base), mappedBytes(other.mappedBytes),
+      count(other.count), syncedCount(other.syncedCount) {
+    other.fd = -1;
+    other.base = nullptr;
+    other.mappedBytes = 0;
+    other.count = 0;
+    other.syncedCount = 0;
+}
+
+MappedFigureStore& MappedFigureStore::operator=(MappedFigureStore&& other) noexcept {
+    if (this != &other) {
+        close();
+        path = std::move(other.path);
+        std::swap(fd, other.fd);
+        std::swap(base, other.base);
+        std::swap(mappedBytes, other.mappedBytes);
+        std::swap(count, other.count);
+        std::swap(syncedCount, other.syncedCount);
+    }
+    return *this;
+}
+
+MappedFigureStore::~MappedFigureStore() {
+    close();
+}
+
+FigureRecord* MappedFigureStore::records() const {
+    return reinterpret_cast<FigureRecord*>(base + HEADER_SIZE);
+}
+
+void MappedFigureStore::map(size_t capacity) {
+    size_t bytes = fileBytes(capacity);
+    void* address = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+        fail("Cannot map", path);
+    }
+    base = static_cast<unsigned char*>(address);
+    mappedBytes = bytes;
+}
+
+void MappedFigureStore::unmap() {
+    if (base) {
+        ::munmap(base, mappedBytes);
+        base = nullptr;
+        mappedBytes = 0;
+    }
+}
+
+MappedFigureStore MappedFigureStore::create(const std::string& path, size_t capacity) {
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        fail("Cannot create", path);
+    }
+    MappedFigureStore store(path, fd);
+    capacity = std::max<size_t>(capacity, 1);
+    if (::ftruncate(fd, static_cast<off_t>(fileBytes(capacity))) != 0) {
+        fail("Cannot resize", path);
+    }
+    store.map(capacity);
+    Header& h = store.header();
+    std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.recordSize = sizeof(FigureRecord);
+    h.count = 0;
+    h.capacity = capacity;
+    h.sequence = 0;
+    store.sync();
+    return store;
+}
+
+MappedFigureStore MappedFigureStore::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDWR);
+    if (fd < 0) {
+        fail("Cannot open", path);
+    }
+    MappedFigureStore store(path, fd);
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        fail("Cannot stat", path);
+    }
+    size_t bytes = static_cast<size_t>(info.st_size);
+    if (bytes < HEADER_SIZE) {
+        throw std::runtime_error("Not a figure store: " + path);
+    }
+    store.map((bytes - HEADER_SIZE) / sizeof(FigureRecord));
+    const Header& h = store.header();
+    if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0 || h.version != VERSION ||
+        h.recordSize != sizeof(FigureRecord) || h.count > h.capacity || fileBytes(h.capacity) > bytes) {
+        throw std::runtime_error("Not a figure store: " + path);
+    }
+    store.count = store.syncedCount = h.count;
+    return store;
+}
+
+size_t MappedFigureStore::capacity() const {
+    return base ? header().capacity : 0;
+}
+
+const FigureRecord& MappedFigureStore::record(size_t index) const {
+    if (index >= count) {
+        throw std::out_of_range("Record index out of range");
+    }
+    return records()[index];
+}
+
+std::shared_ptr<Figure> MappedFigureStore::figure(size_t index) const {
+    return FigureRecords::decode(record(index));
+}
+
+void MappedFigureStore::append(const Figure& fig) {
+    if (!base) {
+        throw std::logic_error("Figure store is closed");
+    }
+    FigureRecord encoded = FigureRecords::encode(fig);
+    if (count == capacity()) {
+        size_t grown = capacity() * 2;
+        if (::ftruncate(fd, static_cast<off_t>(fileBytes(grown))) != 0) {
+            fail("Cannot resize", path);
+        }
+        unmap();
+        map(grown);
+        header().capacity = grown;
+    }
+    records()[count++] = encoded;
+}
+
+void MappedFigureStore::append(const FigureArray& figures) {
+    for (const auto& fig : figures) {
+        append(*fig);
+    }
+}
+
+void MappedFigureStore::sync() {
+    if (!base) {
+        return;
+    }
+    if (count > syncedCount) {
+        // msync требует адрес, выровненный по странице.
+        size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        size_t from = (HEADER_SIZE + syncedCount * sizeof(FigureRecord)) / page * page;
+        size_t to = HEADER_SIZE + count * sizeof(FigureRecord);
+        if (::msync(base + from, to - from, MS_SYNC) != 0) {
+            fail("Cannot sync", path);
+        }
+    }
+    header().count = count;
+    if (::msync(base, HEADER_SIZE, MS_SYNC) != 0) {
+        fail("Cannot sync", path);
+    }
+    syncedCount = count;
+}
+
+void MappedFigureStore::close() {
+    if (base) {
+        header().count = count;
+        unmap();
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
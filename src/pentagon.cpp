@@ -1,22 +1,27 @@
 #include "pentagon.h"
+#include "affine.h"
+#include "predicates.h"
 #include <stdexcept>
 
 void Pentagon::validate() const {
     if (!validState) {
         throw std::runtime_error("Pentagon is in invalid state");
     }
+    if (verified) {
+        return;
+    }
     int sign = 0;
     for (int i = 0; i < 5; ++i) {
         const Point& a = vertices[i];
         const Point& b = vertices[(i + 1) % 5];
         const Point& c = vertices[(i + 2) % 5];
-        double cross = GeometryUtils::crossProduct(a, b, c);
-        if (std::abs(cross) < GeometryUtils::EPSILON) {
+        if (GeometryUtils::areCollinear(a, b, c)) {
             throw std::runtime_error("Invalid pentagon: three consecutive points are collinear");
         }
+        int turn = Predicates::orientation(a, b, c);
         if (sign == 0) {
-            sign = (cross > 0) ? 1 : -1;
-        } else if ((cross > 0 && sign < 0) || (cross < 0 && sign > 0)) {
+            sign = turn;
+        } else if (turn != sign) {
             throw std::runtime_error("Invalid pentagon: polygon is not convex");
         }
     }
@@ -36,6 +41,7 @@ Pentagon::Pentagon(const Point& p1, const Point& p2, const Point& p3, const Poin
     vertices[4] = p5;
     validState = true;
     validate();
+    verified = true;
 }
 
 Point Pentagon::geometricCenter() const {
@@ -78,7 +84,9 @@ void Pentagon::read(std::istream& is) {
         vertices[i] = Point(x, y);
     }
     validState = true;
+    verified = false;
     validate();
+    verified = true;
 }
 
 std::shared_ptr<Figure> Pentagon::clone() const {
@@ -111,6 +119,7 @@ void Pentagon::setVertex(size_t index, const Point& p) {
     }
     vertices[index] = p;
     validState = true;
+    verified = false;
 }
 
 void Pentagon::clearVertices() {
@@ -118,6 +127,34 @@ void Pentagon::clearVertices() {
         vertices[i] = Point(0, 0);
     }
     validState = false;
+    verified = false;
+}
+
+void Pentagon::transform(const AffineTransform& m) {
+    validate();
+    if (!m.isInvertible()) {
+        throw std::runtime_error("Invalid pentagon: transform is degenerate");
+    }
+    // невырожденное аффинное преобразование сохраняет параллельность и
+    // выпуклость, а допуски проверки относительные - проверять заново незачем
+    GeometryUtils::transformPoints(vertices, VERTEX_COUNT, m);
+    verified = true;
+}
+
+bool Pentagon::transformMayFail(const AffineTransform& m) const {
+    return !verified || !m.isInvertible();
+}
+
+Figure::CheckState Pentagon::checkState() const {
+    if (!validState) {
+        return CheckState::EMPTY;
+    }
+    return verified ? CheckState::VERIFIED : CheckState::PENDING;
+}
+
+void Pentagon::restoreCheckState(CheckState state) {
+    validState = state != CheckState::EMPTY;
+    verified = state == CheckState::VERIFIED;
 }
 
 Pentagon& Pentagon::operator=(const Pentagon& other) {
@@ -126,6 +163,7 @@ Pentagon& Pentagon::operator=(const Pentagon& other) {
             vertices[i] = other.vertices[i];
         }
         validState = other.validState;
+        verified = other.verified;
     }
     return *this;
 }
@@ -136,7 +174,9 @@ Pentagon& Pentagon::operator=(Pentagon&& other) noexcept {
             vertices[i] = std::move(other.vertices[i]);
         }
         validState = other.validState;
+        verified = other.verified;
         other.validState = false;
+        other.verified = false;
     }
     return *this;
 }
\ No newline at end of file
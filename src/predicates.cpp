@@ -0,0 +1,128 @@
+#include "predicates.h"
+#include <cmath>
+#include <limits>
+
+namespace {
+    // Машинный эпсилон в смысле Shewchuk: 2^-53.
+    const double HALF_ULP = std::numeric_limits<double>::epsilon() / 2.0;
+    const double CCW_ERRBOUND = (3.0 + 16.0 * HALF_ULP) * HALF_ULP;
+
+    const int MAX_COMPONENTS = 32;
+
+    // x + y == a + b точно, |y| <= ulp(x) / 2.
+    inline void twoSum(double a, double b, double& x, double& y) {
+        x = a + b;
+        double bVirtual = x - a;
+        double aVirtual = x - bVirtual;
+        y = (a - aVirtual) + (b - bVirtual);
+    }
+
+    // x + y == a * b точно.
+    inline void twoProduct(double a, double b, double& x, double& y) {
+        x = a * b;
+        y = std::fma(a, b, -x);
+    }
+
+    // Неперекрывающееся разложение, компоненты по возрастанию модуля.
+    struct Expansion {
+        double components[MAX_COMPONENTS];
+        int size = 0;
+
+        void add(double b) {
+            double q = b;
+            int count = 0;
+            for (int i = 0; i < size; ++i) {
+                double sum, tail;
+                twoSum(q, components[i], sum, tail);
+                if (tail != 0.0) {
+                    components[count++] = tail;
+                }
+                q = sum;
+            }
+            if (q != 0.0 || count == 0) {
+                components[count++] = q;
+            }
+            size = count;
+        }
+
+        void addProduct(double a, double b) {
+            double product, error;
+            twoProduct(a, b, product, error);
+            add(error);
+            add(product);
+        }
+
+        double estimate() const {
+            double sum = 0;
+            for (int i = 0; i < size; ++i) {
+                sum += components[i];
+            }
+            // приближённая сумма может потерять знак, старшая компонента - нет
+            if (size > 0 && (sum > 0) != (components[size - 1] > 0)) {
+                return components[size - 1];
+            }
+            return sum;
+        }
+    };
+
+    // Фильтр для выражения left - right, где left и right - произведения разностей.
+    inline bool filter(double left, double right, double& det) {
+        det = left - right;
+        double detSum;
+        if (left > 0) {
+            if (right <= 0) {
+                return true;
+            }
+            detSum = left + right;
+        } else if (left < 0) {
+            if (right >= 0) {
+                return true;
+            }
+            detSum = -left - right;
+        } else {
+            return true;
+        }
+        double errBound = CCW_ERRBOUND * detSum;
+        return det >= errBound || -det >= errBound;
+    }
+}
+
+namespace Predicates {
+    double orient2d(const Point& a, const Point& b, const Point& c) {
+        double det;
+        if (filter((a.x - c.x) * (b.y - c.y), (a.y - c.y) * (b.x - c.x), det)) {
+            return det;
+        }
+        // (a - c) x (b - c), раскрытое в сумму попарных произведений координат
+        Expansion e;
+        e.addProduct(a.x, b.y);
+        e.addProduct(-a.x, c.y);
+        e.addProduct(-c.x, b.y);
+        e.addProduct(-a.y, b.x);
+        e.addProduct(a.y, c.x);
+        e.addProduct(c.y, b.x);
+        return e.estimate();
+    }
+
+    double cross2d(const Point& a, const Point& b, const Point& c, const Point& d) {
+        double det;
+        if (filter((b.x - a.x) * (d.y - c.y), (b.y - a.y) * (d.x - c.x), det)) {
+            return det;
+        }
+        Expansion e;
+        e.addProduct(b.x, d.y);
+        e.addProduct(-b.x, c.y);
+        e.addProduct(-a.x, d.y);
+        e.addProduct(a.x, c.y);
+        e.addProduct(-b.y, d.x);
+        e.addProduct(b.y, c.x);
+        e.addProduct(a.y, d.x);
+        e.addProduct(-a.y, c.x);
+        return e.estimate();
+    }
+
+    int orientation(const Point& a, const Point& b, const Point& c) {
+        double det = orient2d(a, b, c);
+        return (det > 0) - (det < 0);
+    }
+}
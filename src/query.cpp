@@ -0,0 +1,494 @@
+#include "query.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+    const size_t QUERY_BLOCK = 4096;
+}
+
+struct Query::Node {
+    enum Kind { True, Type, Compare, BoxIntersects, BoxWithin, And, Or, Not };
+
+    Kind kind;
+    FigureKey key = FigureKey::Area;
+    ::Compare compare = ::Compare::Equal;
+    double value = 0;
+    BoundingBox box;
+    std::string name;
+    std::shared_ptr<const Node> left;
+    std::shared_ptr<const Node> right;
+
+    explicit Node(Kind kind) : kind(kind) {}
+};
+
+Query::Query() : root(std::make_shared<Node>(Node::True)) {}
+
+Query Query::type(const std::string& name) {
+    auto node = std::make_shared<Node>(Node::Type);
+    node->name = name;
+    return Query(node);
+}
+
+Query Query::compare(FigureKey key, Compare op, double value) {
+    auto node = std::make_shared<Node>(Node::Compare);
+    node->key = key;
+    node->compare = op;
+    node->value = value;
+    return Query(node);
+}
+
+Query Query::bboxIntersects(const BoundingBox& box) {
+    auto node = std::make_shared<Node>(Node::BoxIntersects);
+    node->box = box;
+    return Query(node);
+}
+
+Query Query::bboxWithin(const BoundingBox& box) {
+    auto node = std::make_shared<Node>(Node::BoxWithin);
+    node->box = box;
+    return Query(node);
+}
+
+Query Query::operator&&(const Query& other) const {
+    auto node = std::make_shared<Node>(Node::And);
+    node->left = root;
+    node->right = other.root;
+    return Query(node);
+}
+
+Query Query::operator||(const Query& other) const {
+    auto node = std::make_shared<Node>(Node::Or);
+    node->left = root;
+    node->right = other.root;
+    return Query(node);
+}
+
+Query Query::operator!() const {
+    auto node = std::make_shared<Node>(Node::Not);
+    node->left = root;
+    return Query(node);
+}
+
+namespace {
+    // Рекурсивный спуск: or := and ('||' and)*; and := unary ('&&' unary)*;
+    // unary := '!' unary | '(' or ')' | условие.
+    class Parser {
+    private:
+        const std::string& text;
+        size_t pos = 0;
+
+        [[noreturn]] void fail(const std::string& message) const {
+            throw std::invalid_argument("Query error at position " + std::to_string(pos) + ": " + message);
+        }
+
+        void skipSpaces() {
+            while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) {
+                ++pos;
+            }
+        }
+
+        bool accept(const char* token) {
+            skipSpaces();
+            size_t length = std::strlen(token);
+            if (text.compare(pos, length, token) != 0) {
+                return false;
+            }
+            // "!" не должен съедать начало "!=", "<" - начало "<=" и т.п.
+            if (length == 1 && pos + 1 < text.size() && text[pos + 1] == '=' && std::strchr("!<>", token[0])) {
+                return false;
+            }
+            pos += length;
+            return true;
+        }
+
+        void expect(const char* token) {
+            if (!accept(token)) {
+                fail(std::string("expected '") + token + "'");
+            }
+        }
+
+        std::string identifier() {
+            skipSpaces();
+            size_t start = pos;
+            while (pos < text.size() && (std::isalnum(static_cast<unsigned char>(text[pos])) || text[pos] == '_')) {
+                ++pos;
+            }
+            if (start == pos) {
+                fail("expected identifier");
+            }
+            return text.substr(start, pos - start);
+        }
+
+        double number() {
+            skipSpaces();
+            const char* begin = text.c_str() + pos;
+            char* end = nullptr;
+            double value = std::strtod(begin, &end);
+            if (end == begin) {
+                fail("expected number");
+            }
+            pos += end - begin;
+            return value;
+        }
+
+        Compare comparison() {
+            if (accept("<=")) return Compare::LessEqual;
+            if (accept(">=")) return Compare::GreaterEqual;
+            if (accept("==")) return Compare::Equal;
+            if (accept("!=")) return Compare::NotEqual;
+            if (accept("<")) return Compare::Less;
+            if (accept(">")) return Compare::Greater;
+            fail("expected comparison");
+        }
+
+        BoundingBox box() {
+            expect("[");
+            double minX = number();
+            expect(",");
+            double minY = number();
+            expect(",");
+            double maxX = number();
+            expect(",");
+            double maxY = number();
+            expect("]");
+            return BoundingBox(minX, minY, maxX, maxY);
+        }
+
+        Query condition() {
+            size_t start = pos;
+            std::string word = identifier();
+            if (word == "type") {
+                if (accept("==")) {
+                    return Query::type(identifier());
+                }
+                if (accept("!=")) {
+                    return !Query::type(identifier());
+                }
+                fail("expected '==' or '!=' after 'type'");
+            }
+            if (word == "bbox") {
+                std::string relation = identifier();
+                if (relation == "intersects") {
+                    return Query::bboxIntersects(box());
+                }
+                if (relation == "within") {
+                    return Query::bboxWithin(box());
+                }
+                fail("expected 'intersects' or 'within' after 'bbox'");
+            }
+            FigureKey key;
+            if (word == "area") {
+                key = FigureKey::Area;
+            } else if (word == "perimeter") {
+                key = FigureKey::Perimeter;
+            } else if (word == "x") {
+                key = FigureKey::CenterX;
+            } else if (word == "y") {
+                key = FigureKey::CenterY;
+            } else {
+                pos = start;
+                fail("unknown field '" + word + "'");
+            }
+            Compare op = comparison();
+            return Query::compare(key, op, number());
+        }
+
+        Query unary() {
+            if (accept("!")) {
+                return !unary();
+            }
+            if (accept("(")) {
+                Query inner = disjunction();
+                expect(")");
+                return inner;
+            }
+            return condition();
+        }
+
+        Query conjunction() {
+            Query result = unary();
+            while (accept("&&")) {
+                result = result && unary();
+            }
+            return result;
+        }
+
+        Query disjunction() {
+            Query result = conjunction();
+            while (accept("||")) {
+                result = result || conjunction();
+            }
+            return result;
+        }
+
+    public:
+        explicit Parser(const std::string& text) : text(text) {}
+
+        Query parse() {
+            Query result = disjunction();
+            skipSpaces();
+            if (pos != text.size()) {
+                fail("unexpected input");
+            }
+            return result;
+        }
+    };
+
+    typedef CompiledQuery::Instruction Instruction;
+    typedef CompiledQuery::Op Op;
+
+    Instruction instruction(Op op) {
+        Instruction result;
+        result.op = op;
+        result.key = FigureKey::Area;
+        result.compare = Compare::Equal;
+        result.value = 0;
+        result.target = 0;
+        return result;
+    }
+
+    void emit(const Query::Node& node, std::vector<Instruction>& program) {
+        switch (node.kind) {
+        case Query::Node::True:
+            program.push_back(instruction(Op::True));
+            break;
+        case Query::Node::Type: {
+            Instruction ins = instruction(Op::TypeEquals);
+            ins.typeName = node.name;
+            program.push_back(ins);
+            break;
+        }
+        case Query::Node::Compare: {
+            Instruction ins = instruction(Op::Compare);
+            ins.key = node.key;
+            ins.compare = node.compare;
+            ins.value = node.value;
+            program.push_back(ins);
+            break;
+        }
+        case Query::Node::BoxIntersects:
+        case Query::Node::BoxWithin: {
+            Instruction ins = instruction(node.kind == Query::Node::BoxWithin ? Op::BoxWithin : Op::BoxIntersects);
+            ins.box = node.box;
+            program.push_back(ins);
+            break;
+        }
+        case Query::Node::Not:
+            emit(*node.left, program);
+            program.push_back(instruction(Op::Not));
+            break;
+        case Query::Node::And:
+        case Query::Node::Or: {
+            // Результат левой части остаётся в регистре, если правая пропущена.
+            emit(*node.left, program);
+            size_t jump = program.size();
+            program.push_back(instruction(node.kind == Query::Node::And ? Op::JumpIfFalse : Op::JumpIfTrue));
+            emit(*node.right, program);
+            program[jump].target = program.size();
+            break;
+        }
+        }
+    }
+
+    // Характеристики фигуры, вычисляемые по первому требованию.
+    struct Lazy {
+        const Figure& fig;
+        bool hasArea = false, hasPerimeter = false, hasCenter = false, hasBox = false;
+        double area = 0, perimeter = 0;
+        Point center;
+        BoundingBox box;
+
+        explicit Lazy(const Figure& fig) : fig(fig) {}
+
+        double key(FigureKey key) {
+            switch (key) {
+            case FigureKey::Area:
+                if (!hasArea) {
+                    area = fig.area();
+                    hasArea = true;
+                }
+                return area;
+            case FigureKey::Perimeter:
+                if (!hasPerimeter) {
+                    perimeter = GeometryUtils::perimeter(fig);
+                    hasPerimeter = true;
+                }
+                return perimeter;
+            case FigureKey::CenterX:
+            case FigureKey::CenterY:
+                if (!hasCenter) {
+                    center = fig.geometricCenter();
+                    hasCenter = true;
+                }
+                return key == FigureKey::CenterX ? center.x : center.y;
+            }
+            return 0;
+        }
+
+        const BoundingBox& bounds() {
+            if (!hasBox) {
+                box = GeometryUtils::boundingBox(fig);
+                hasBox = true;
+            }
+            return box;
+        }
+    };
+
+    bool compare(double lhs, Compare op, double rhs) {
+        switch (op) {
+        case Compare::Less: return lhs < rhs;
+        case Compare::LessEqual: return lhs <= rhs;
+        case Compare::Greater: return lhs > rhs;
+        case Compare::GreaterEqual: return lhs >= rhs;
+        case Compare::Equal: return lhs == rhs;
+        case Compare::NotEqual: return lhs != rhs;
+        }
+        return false;
+    }
+}
+
+QueryConstraints::QueryConstraints()
+    : minArea(-std::numeric_limits<double>::infinity()), maxArea(std::numeric_limits<double>::infinity()) {}
+
+namespace {
+    void collect(const Query::Node& node, QueryConstraints& out) {
+        switch (node.kind) {
+        case Query::Node::And:
+            collect(*node.left, out);
+            collect(*node.right, out);
+            break;
+        case Query::Node::Type:
+            // Два разных типа одновременно невозможны; оставляем первый, проверка всё отсеет.
+            if (out.type.empty()) {
+                out.type = node.name;
+            }
+            break;
+        case Query::Node::Compare:
+            if (node.key != FigureKey::Area) {
+                break;
+            }
+            if (node.compare == Compare::Less || node.compare == Compare::LessEqual || node.compare == Compare::Equal) {
+                out.maxArea = std::min(out.maxArea, node.value);
+            }
+            if (node.compare == Compare::Greater || node.compare == Compare::GreaterEqual ||
+                node.compare == Compare::Equal) {
+                out.minArea = std::max(out.minArea, node.value);
+            }
+            break;
+        case Query::Node::BoxIntersects:
+        case Query::Node::BoxWithin:
+            // Рамка внутри окна тем более его пересекает. Рамка, пересекающая
+            // два окна, пересекает и их общую часть (по каждой оси - отрезки),
+            // но только если та не пуста: иначе остаётся первое окно.
+            if (!out.hasWindow) {
+                out.window = node.box;
+                out.hasWindow = true;
+            } else {
+                BoundingBox common(std::max(out.window.minX, node.box.minX),
+                                   std::max(out.window.minY, node.box.minY),
+                                   std::min(out.window.maxX, node.box.maxX),
+                                   std::min(out.window.maxY, node.box.maxY));
+                if (!common.isEmpty()) {
+                    out.window = common;
+                }
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+QueryConstraints Query::constraints() const {
+    QueryConstraints result;
+    collect(*root, result);
+    return result;
+}
+
+Query Query::parse(const std::string& text) {
+    return Parser(text).parse();
+}
+
+CompiledQuery Query::compile() const {
+    CompiledQuery result;
+    emit(*root, result.program);
+    return result;
+}
+
+bool CompiledQuery::matches(const Figure& fig) const {
+    Lazy lazy(fig);
+    bool acc = true;
+    size_t pc = 0;
+    while (pc < program.size()) {
+        const Instruction& ins = program[pc++];
+        switch (ins.op) {
+        case Op::True:
+            acc = true;
+            break;
+        case Op::TypeEquals:
+            acc = ins.typeName == fig.typeName();
+            break;
+        case Op::Compare:
+            acc = compare(lazy.key(ins.key), ins.compare, ins.value);
+            break;
+        case Op::BoxIntersects:
+            acc = ins.box.intersects(lazy.bounds());
+            break;
+        case Op::BoxWithin:
+            acc = ins.box.contains(lazy.bounds());
+            break;
+        case Op::Not:
+            acc = !acc;
+            break;
+        case Op::JumpIfFalse:
+            if (!acc) {
+                pc = ins.target;
+            }
+            break;
+        case Op::JumpIfTrue:
+            if (acc) {
+                pc = ins.target;
+            }
+            break;
+        }
+    }
+    return acc;
+}
+
+std::vector<size_t> CompiledQuery::select(const FigureArray& figures) const {
+    std::vector<std::vector<size_t>> partial(Parallel::workerCount(figures.size(), QUERY_BLOCK));
+    Parallel::forBlocks(figures.size(), QUERY_BLOCK, [&](size_t worker, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (matches(*figures.at(i))) {
+                partial[worker].push_back(i);
+            }
+        }
+    });
+    // Блоки идут по возрастанию индексов, поэтому склейка сохраняет порядок.
+    std::vector<size_t> result;
+    for (const auto& part : partial) {
+        result.insert(result.end(), part.begin(), part.end());
+    }
+    return result;
+}
+
+size_t CompiledQuery::count(const FigureArray& figures) const {
+    std::vector<size_t> partial(Parallel::workerCount(figures.size(), QUERY_BLOCK), 0);
+    Parallel::forBlocks(figures.size(), QUERY_BLOCK, [&](size_t worker, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (matches(*figures.at(i))) {
+                ++partial[worker];
+            }
+        }
+    });
+    size_t total = 0;
+    for (size_t part : partial) {
+        total += part;
+    }
+    return total;
+}
@@ -0,0 +1,303 @@
+#include "query_planner.h"
+#include "figure_order.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+namespace {
+    const size_t VERIFY_BLOCK = 4096;
+    const size_t MAX_GRID_SIDE = 1024;
+
+    // Условные единицы: проверка одной фигуры полным запросом (виртуальные
+    // вызовы, вычисление площади и рамки) стоит ROW_COST.
+    const double ROW_COST = 1.0;
+    // Переход к фигуре по произвольному индексу вместо последовательного.
+    const double GATHER_COST = 0.5;
+    // Одно условие по хранимому столбцу.
+    const double COLUMN_COST = 0.05;
+    // Множитель n log n при восстановлении порядка кандидатов.
+    const double SORT_COST = 0.03;
+
+    const char* pathName(AccessPath path) {
+        switch (path) {
+        case AccessPath::FullScan: return "FullScan";
+        case AccessPath::ColumnScan: return "ColumnScan";
+        case AccessPath::TypeIndex: return "TypeIndex";
+        case AccessPath::AreaIndex: return "AreaIndex";
+        case AccessPath::SpatialIndex: return "SpatialIndex";
+        }
+        return "";
+    }
+
+    double logCost(double n) {
+        return std::log(n + 2) / std::log(2.0);
+    }
+
+    double workers(double rows) {
+        return static_cast<double>(Parallel::workerCount(static_cast<size_t>(rows), VERIFY_BLOCK));
+    }
+
+    size_t clampCell(double offset, double cell, size_t count) {
+        if (!(offset > 0)) {
+            return 0;
+        }
+        double index = std::floor(offset / cell);
+        return index >= count - 1 ? count - 1 : static_cast<size_t>(index);
+    }
+}
+
+std::string QueryPlan::describe() const {
+    std::ostringstream os;
+    os << pathName(path) << ": ~" << static_cast<size_t>(estimatedCandidates + 0.5) << " candidates, ~"
+       << static_cast<size_t>(estimatedMatches + 0.5) << " checked, cost " << estimatedCost;
+    return os.str();
+}
+
+bool QueryPlanner::Grid::cellRange(const BoundingBox& window, size_t& c0, size_t& r0, size_t& c1, size_t& r1) const {
+    if (columns == 0 || window.isEmpty()) {
+        return false;
+    }
+    // Центр рамки, пересекающей окно, лежит в окне, расширенном на полуразмеры.
+    BoundingBox expanded(window.minX - halfWidth, window.minY - halfHeight,
+                         window.maxX + halfWidth, window.maxY + halfHeight);
+    if (!expanded.intersects(extent)) {
+        return false;
+    }
+    c0 = clampCell(expanded.minX - extent.minX, cellWidth, columns);
+    c1 = clampCell(expanded.maxX - extent.minX, cellWidth, columns);
+    r0 = clampCell(expanded.minY - extent.minY, cellHeight, rows);
+    r1 = clampCell(expanded.maxY - extent.minY, cellHeight, rows);
+    return true;
+}
+
+QueryPlanner::QueryPlanner(const FigureArray& figures) : figures(&figures) {
+    rebuild();
+}
+
+void QueryPlanner::rebuild() {
+    std::vector<FigureMetrics> metrics = figures->metrics();
+    size_t n = metrics.size();
+
+    byType.clear();
+    types.resize(n);
+    areas.resize(n);
+    boxes.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        types[i] = figures->at(i)->typeName();
+        areas[i] = metrics[i].area;
+        boxes[i] = metrics[i].box;
+        byType[types[i]].push_back(i);
+    }
+
+    areaOrder = FigureKeys::sortedPermutation(areas);
+    sortedAreas.resize(n);
+    for (size_t k = 0; k < n; ++k) {
+        sortedAreas[k] = areas[areaOrder[k]];
+    }
+
+    grid = Grid();
+    if (n == 0) {
+        return;
+    }
+    for (const FigureMetrics& m : metrics) {
+        grid.extent.expand(m.box);
+        grid.halfWidth = std::max(grid.halfWidth, m.box.width() / 2);
+        grid.halfHeight = std::max(grid.halfHeight, m.box.height() / 2);
+    }
+    // Около двух фигур на ячейку.
+    size_t side = static_cast<size_t>(std::ceil(std::sqrt(n / 2.0)));
+    side = std::max<size_t>(1, std::min(side, MAX_GRID_SIDE));
+    grid.columns = side;
+    grid.rows = side;
+    grid.cellWidth = grid.extent.width() > 0 ? grid.extent.width() / side : 1;
+    grid.cellHeight = grid.extent.height() > 0 ? grid.extent.height() / side : 1;
+
+    std::vector<size_t> cellOf(n);
+    grid.cellStart.assign(side * side + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        const BoundingBox& box = metrics[i].box;
+        size_t column = clampCell((box.minX + box.maxX) / 2 - grid.extent.minX, grid.cellWidth, side);
+        size_t row = clampCell((box.minY + box.maxY) / 2 - grid.extent.minY, grid.cellHeight, side);
+        cellOf[i] = row * side + column;
+        ++grid.cellStart[cellOf[i] + 1];
+    }
+    for (size_t c = 0; c < side * side; ++c) {
+        grid.cellStart[c + 1] += grid.cellStart[c];
+    }
+    grid.items.resize(n);
+    std::vector<size_t> fill(grid.cellStart.begin(), grid.cellStart.end() - 1);
+    for (size_t i = 0; i < n; ++i) {
+        grid.items[fill[cellOf[i]]++] = i;
+    }
+
+    size_t stride = side + 1;
+    grid.prefix.assign(stride * stride, 0);
+    for (size_t r = 0; r < side; ++r) {
+        for (size_t c = 0; c < side; ++c) {
+            size_t cell = r * side + c;
+            grid.prefix[(r + 1) * stride + c + 1] = grid.cellStart[cell + 1] - grid.cellStart[cell] +
+                grid.prefix[r * stride + c + 1] + grid.prefix[(r + 1) * stride + c] - grid.prefix[r * stride + c];
+        }
+    }
+}
+
+size_t QueryPlanner::areaRange(double low, double high, size_t& first, size_t& last) const {
+    first = std::lower_bound(sortedAreas.begin(), sortedAreas.end(), low) - sortedAreas.begin();
+    last = std::upper_bound(sortedAreas.begin(), sortedAreas.end(), high) - sortedAreas.begin();
+    if (last < first) {
+        last = first;
+    }
+    return last - first;
+}
+
+size_t QueryPlanner::spatialCount(const BoundingBox& window) const {
+    size_t c0, r0, c1, r1;
+    if (!grid.cellRange(window, c0, r0, c1, r1)) {
+        return 0;
+    }
+    size_t stride = grid.columns + 1;
+    return grid.prefix[(r1 + 1) * stride + c1 + 1] - grid.prefix[r0 * stride + c1 + 1] -
+           grid.prefix[(r1 + 1) * stride + c0] + grid.prefix[r0 * stride + c0];
+}
+
+std::vector<size_t> QueryPlanner::candidates(AccessPath path, const QueryConstraints& constraints) const {
+    std::vector<size_t> result;
+    switch (path) {
+    case AccessPath::TypeIndex: {
+        auto it = byType.find(constraints.type);
+        if (it != byType.end()) {
+            result = it->second;
+        }
+        return result;
+    }
+    case AccessPath::AreaIndex: {
+        size_t first, last;
+        areaRange(constraints.minArea, constraints.maxArea, first, last);
+        result.assign(areaOrder.begin() + first, areaOrder.begin() + last);
+        break;
+    }
+    case AccessPath::SpatialIndex: {
+        size_t c0, r0, c1, r1;
+        if (!grid.cellRange(constraints.window, c0, r0, c1, r1)) {
+            return result;
+        }
+        for (size_t r = r0; r <= r1; ++r) {
+            size_t begin = grid.cellStart[r * grid.columns + c0];
+            size_t end = grid.cellStart[r * grid.columns + c1 + 1];
+            result.insert(result.end(), grid.items.begin() + begin, grid.items.begin() + end);
+        }
+        break;
+    }
+    default:
+        return result;
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+bool QueryPlanner::passesColumns(size_t index, const QueryConstraints& constraints) const {
+    return (constraints.type.empty() || constraints.type == types[index]) &&
+           areas[index] >= constraints.minArea && areas[index] <= constraints.maxArea &&
+           (!constraints.hasWindow || constraints.window.intersects(boxes[index]));
+}
+
+QueryPlan QueryPlanner::plan(const Query& query) const {
+    QueryConstraints constraints = query.constraints();
+    double n = static_cast<double>(figures->size());
+
+    QueryPlan best;
+    best.path = AccessPath::FullScan;
+    best.estimatedCandidates = n;
+    best.estimatedMatches = n;
+    best.estimatedCost = n * ROW_COST / workers(n);
+    if (n == 0) {
+        return best;
+    }
+
+    struct Condition {
+        AccessPath index;
+        double rows;  // кандидатов по индексу
+        double probe; // поиск и упорядочивание кандидатов
+    };
+    std::vector<Condition> conditions;
+    if (!constraints.type.empty()) {
+        auto it = byType.find(constraints.type);
+        double k = it == byType.end() ? 0 : static_cast<double>(it->second.size());
+        // Списки типов уже упорядочены по индексу.
+        conditions.push_back(Condition{AccessPath::TypeIndex, k, logCost(static_cast<double>(byType.size()))});
+    }
+    if (constraints.minArea > -std::numeric_limits<double>::infinity() ||
+        constraints.maxArea < std::numeric_limits<double>::infinity()) {
+        size_t first, last;
+        double k = static_cast<double>(areaRange(constraints.minArea, constraints.maxArea, first, last));
+        conditions.push_back(Condition{AccessPath::AreaIndex, k, 2 * logCost(n) + k * SORT_COST * logCost(k)});
+    }
+    if (constraints.hasWindow) {
+        // Оценка сверху: все фигуры ячеек, которые может задеть окно.
+        double k = static_cast<double>(spatialCount(constraints.window));
+        conditions.push_back(Condition{AccessPath::SpatialIndex, k, 4 + k * SORT_COST * logCost(k)});
+    }
+    if (conditions.empty()) {
+        return best;
+    }
+
+    double selectivity = 1;
+    for (const Condition& condition : conditions) {
+        selectivity *= condition.rows / n;
+    }
+    double matches = n * selectivity;
+    double verify = matches * (GATHER_COST + ROW_COST);
+    double columns = COLUMN_COST * conditions.size();
+
+    double scanCost = (n * columns + verify) / workers(n);
+    if (scanCost < best.estimatedCost) {
+        best.path = AccessPath::ColumnScan;
+        best.estimatedMatches = matches;
+        best.estimatedCost = scanCost;
+    }
+    for (const Condition& condition : conditions) {
+        double cost = condition.probe + (condition.rows * columns + verify) / workers(condition.rows);
+        if (cost < best.estimatedCost) {
+            best.path = condition.index;
+            best.estimatedCandidates = condition.rows;
+            best.estimatedMatches = matches;
+            best.estimatedCost = cost;
+        }
+    }
+    return best;
+}
+
+std::vector<size_t> QueryPlanner::execute(const Query& query) const {
+    return execute(query, plan(query));
+}
+
+std::vector<size_t> QueryPlanner::execute(const Query& query, const QueryPlan& plan) const {
+    CompiledQuery compiled = query.compile();
+    if (plan.path == AccessPath::FullScan) {
+        return compiled.select(*figures);
+    }
+    QueryConstraints constraints = query.constraints();
+    bool scan = plan.path == AccessPath::ColumnScan;
+    std::vector<size_t> pending;
+    if (!scan) {
+        pending = candidates(plan.path, constraints);
+    }
+    size_t rows = scan ? figures->size() : pending.size();
+
+    std::vector<std::vector<size_t>> partial(Parallel::workerCount(rows, VERIFY_BLOCK));
+    Parallel::forBlocks(rows, VERIFY_BLOCK, [&](size_t worker, size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            size_t index = scan ? k : pending[k];
+            if (passesColumns(index, constraints) && compiled.matches(*figures->at(index))) {
+                partial[worker].push_back(index);
+            }
+        }
+    });
+    std::vector<size_t> result;
+    for (const auto& part : partial) {
+        result.insert(result.end(), part.begin(), part.end());
+    }
+    return result;
+}
@@ -1,19 +1,28 @@
 #include "rhombus.h"
+#include "affine.h"
+#include "predicates.h"
+#include <algorithm>
+#include <cmath>
 #include <stdexcept>
 
 void Rhombus::validate() const {
     if (!validState) {
         throw std::runtime_error("Rhombus is in invalid state");
     }
+    if (verified) {
+        return;
+    }
 
     double side1 = GeometryUtils::distance(vertices[0], vertices[1]);
     double side2 = GeometryUtils::distance(vertices[1], vertices[2]);
     double side3 = GeometryUtils::distance(vertices[2], vertices[3]);
     double side4 = GeometryUtils::distance(vertices[3], vertices[0]);
 
-    if (std::abs(side1 - side2) > GeometryUtils::EPSILON ||
-        std::abs(side2 - side3) > GeometryUtils::EPSILON ||
-        std::abs(side3 - side4) > GeometryUtils::EPSILON) {
+    // допуски относительные: поворот и масштаб, в том числе меньше единицы, их не меняют
+    double sideTolerance = GeometryUtils::EPSILON * std::max(std::max(side1, side2), std::max(side3, side4));
+    if (std::abs(side1 - side2) > sideTolerance ||
+        std::abs(side2 - side3) > sideTolerance ||
+        std::abs(side3 - side4) > sideTolerance) {
         throw std::runtime_error("Invalid rhombus: all sides must be equal");
     }
 
@@ -23,14 +32,26 @@ void Rhombus::validate() const {
     double dy2 = vertices[3].y - vertices[1].y;
     double dotProduct = dx1 * dx2 + dy1 * dy2;
 
-    if (std::abs(dotProduct) > GeometryUtils::EPSILON) {
+    double diagonals = std::sqrt((dx1 * dx1 + dy1 * dy1) * (dx2 * dx2 + dy2 * dy2));
+    // косинус угла между диагоналями
+    if (std::abs(dotProduct) > GeometryUtils::EPSILON * diagonals) {
         throw std::runtime_error("Invalid rhombus: diagonals are not perpendicular");
     }
 
+    int sign = 0;
     for (int i = 0; i < 4; ++i) {
-        if (GeometryUtils::areCollinear(vertices[i], vertices[(i + 1) % 4], vertices[(i + 2) % 4])) {
+        const Point& a = vertices[i];
+        const Point& b = vertices[(i + 1) % 4];
+        const Point& c = vertices[(i + 2) % 4];
+        if (GeometryUtils::areCollinear(a, b, c)) {
             throw std::runtime_error("Invalid rhombus: three consecutive points are collinear");
         }
+        int turn = Predicates::orientation(a, b, c);
+        if (sign == 0) {
+            sign = turn;
+        } else if (turn != sign) {
+            throw std::runtime_error("Invalid rhombus: polygon is not convex");
+        }
     }
 }
 
@@ -41,6 +62,7 @@ Rhombus::Rhombus(const Point& p1, const Point& p2, const Point& p3, const Point&
     vertices[3] = p4;
     validState = true;
     validate();
+    verified = true;
 }
 
 Point Rhombus::geometricCenter() const {
@@ -83,7 +105,9 @@ void Rhombus::read(std::istream& is) {
         vertices[i] = Point(x, y);
     }
     validState = true;
+    verified = false;
     validate();
+    verified = true;
 }
 
 std::shared_ptr<Figure> Rhombus::clone() const {
@@ -116,6 +140,7 @@ void Rhombus::setVertex(size_t index, const Point& p) {
     }
     vertices[index] = p;
     validState = true;
+    verified = false;
 }
 
 void Rhombus::clearVertices() {
@@ -123,6 +148,53 @@ void Rhombus::clearVertices() {
         vertices[i] = Point(0, 0);
     }
     validState = false;
+    verified = false;
+}
+
+void Rhombus::transform(const AffineTransform& m) {
+    validate();
+    if (!m.isInvertible()) {
+        throw std::runtime_error("Invalid rhombus: transform is degenerate");
+    }
+    if (m.isSimilarity()) {
+        // равенство сторон и прямой угол между диагоналями сохраняются
+        GeometryUtils::transformPoints(vertices, VERTEX_COUNT, m);
+        verified = true;
+        return;
+    }
+    // остальные преобразования (сдвиг, неравномерный масштаб) ромб обычно разрушают
+    Point backup[VERTEX_COUNT];
+    for (size_t i = 0; i < VERTEX_COUNT; ++i) {
+        backup[i] = vertices[i];
+    }
+    GeometryUtils::transformPoints(vertices, VERTEX_COUNT, m);
+    verified = false;
+    try {
+        validate();
+    } catch (...) {
+        for (size_t i = 0; i < VERTEX_COUNT; ++i) {
+            vertices[i] = backup[i];
+        }
+        verified = true;
+        throw;
+    }
+    verified = true;
+}
+
+bool Rhombus::transformMayFail(const AffineTransform& m) const {
+    return !verified || !m.isInvertible() || !m.isSimilarity();
+}
+
+Figure::CheckState Rhombus::checkState() const {
+    if (!validState) {
+        return CheckState::EMPTY;
+    }
+    return verified ? CheckState::VERIFIED : CheckState::PENDING;
+}
+
+void Rhombus::restoreCheckState(CheckState state) {
+    validState = state != CheckState::EMPTY;
+    verified = state == CheckState::VERIFIED;
 }
 
 Rhombus& Rhombus::operator=(const Rhombus& other) {
@@ -131,6 +203,7 @@ Rhombus& Rhombus::operator=(const Rhombus& other) {
             vertices[i] = other.vertices[i];
         }
         validState = other.validState;
+        verified = other.verified;
     }
     return *this;
 }
@@ -141,7 +214,9 @@ Rhombus& Rhombus::operator=(Rhombus&& other) noexcept {
             vertices[i] = std::move(other.vertices[i]);
         }
         validState = other.validState;
+        verified = other.verified;
         other.validState = false;
+        other.verified = false;
     }
     return *this;
 }
\ No newline at end of file
@@ -0,0 +1,265 @@
+#include "sharded_collection.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+ShardedFigureCollection::ShardedFigureCollection(size_t shardCount, ShardKey key, double cellSize)
+    : key(key), cellSize(cellSize) {
+    if (key == ShardKey::SPATIAL && !(cellSize > 0)) {
+        throw std::invalid_argument("Cell size must be positive");
+    }
+    if (shardCount == 0) {
+        shardCount = Parallel::threadCount();
+    }
+    for (size_t i = 0; i < shardCount; ++i) {
+        shards.emplace_back(new Shard());
+        directory.emplace_back(new Directory());
+    }
+}
+
+size_t ShardedFigureCollection::shardFor(uint64_t id, const Figure& fig) const {
+    uint64_t h;
+    if (key == ShardKey::SPATIAL) {
+        // Центр рамки, а не geometricCenter: тот проверяет геометрию, а после
+        // setVertex фигура может быть некорректной.
+        BoundingBox box = GeometryUtils::boundingBox(fig);
+        long long cx = static_cast<long long>(std::floor((box.minX + box.maxX) / 2 / cellSize));
+        long long cy = static_cast<long long>(std::floor((box.minY + box.maxY) / 2 / cellSize));
+        h = (uint64_t(cx) * 0x9E3779B97F4A7C15ULL) ^ (uint64_t(cy) + 0x632BE59BD9B4E019ULL);
+    } else {
+        h = id * 0x9E3779B97F4A7C15ULL;
+    }
+    // Перемешивание: соседние ячейки и идентификаторы - в разные сегменты.
+    h ^= h >> 31;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 29;
+    return h % shards.size();
+}
+
+bool ShardedFigureCollection::relevant(const Shard& shard, const QueryConstraints* constraints) {
+    if (shard.ids.empty()) {
+        return false;
+    }
+    return !constraints || !constraints->hasWindow || shard.bounds.intersects(constraints->window);
+}
+
+void ShardedFigureCollection::insert(Shard& shard, uint64_t id, std::shared_ptr<const Figure> fig) {
+    shard.bounds.expand(GeometryUtils::boundingBox(*fig));
+    shard.positions[id] = shard.ids.size();
+    shard.ids.push_back(id);
+    shard.figures.addFigure(std::move(fig));
+}
+
+std::shared_ptr<const Figure> ShardedFigureCollection::extract(Shard& shard, uint64_t id) {
+    // Порядок внутри сегмента не важен: на место удалённой встаёт последняя.
+    size_t position = shard.positions.at(id);
+    size_t last = shard.ids.size() - 1;
+    std::shared_ptr<const Figure> fig = shard.figures.at(position);
+    if (position != last) {
+        shard.figures.replaceFigure(position, shard.figures.at(last));
+        shard.ids[position] = shard.ids[last];
+        shard.positions[shard.ids[position]] = position;
+    }
+    shard.figures.removeFigure(last);
+    shard.ids.pop_back();
+    shard.positions.erase(id);
+    if (shard.ids.empty()) {
+        shard.bounds = BoundingBox();
+    }
+    return fig;
+}
+
+uint64_t ShardedFigureCollection::addFigure(std::shared_ptr<const Figure> fig) {
+    if (!fig) {
+        throw std::invalid_argument("Figure must not be null");
+    }
+    uint64_t id = nextId.fetch_add(1, std::memory_order_relaxed);
+    size_t index = shardFor(id, *fig);
+    Directory& entry = directoryFor(id);
+    std::lock_guard<std::mutex> directoryLock(entry.mutex);
+    {
+        std::lock_guard<std::mutex> lock(shards[index]->mutex);
+        insert(*shards[index], id, std::move(fig));
+    }
+    entry.shard[id] = index;
+    return id;
+}
+
+bool ShardedFigureCollection::removeFigure(uint64_t id) {
+    Directory& entry = directoryFor(id);
+    std::lock_guard<std::mutex> directoryLock(entry.mutex);
+    auto it = entry.shard.find(id);
+    if (it == entry.shard.end()) {
+        return false;
+    }
+    {
+        Shard& shard = *shards[it->second];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        extract(shard, id);
+    }
+    entry.shard.erase(it);
+    return true;
+}
+
+void ShardedFigureCollection::setVertex(uint64_t id, size_t vertex, const Point& p) {
+    // Запись каталога держится до конца: фигуру никто не тронет, пока она переезжает.
+    Directory& entry = directoryFor(id);
+    std::lock_guard<std::mutex> directoryLock(entry.mutex);
+    auto it = entry.shard.find(id);
+    if (it == entry.shard.end()) {
+        throw std::out_of_range("Unknown figure id");
+    }
+    Shard& from = *shards[it->second];
+    std::unique_lock<std::mutex> fromLock(from.mutex);
+    size_t position = from.positions.at(id);
+    from.figures.setVertex(position, vertex, p);
+    const Figure& fig = *from.figures.at(position);
+    size_t target = key == ShardKey::SPATIAL ? shardFor(id, fig) : it->second;
+    if (target == it->second) {
+        from.bounds.expand(GeometryUtils::boundingBox(fig));
+        return;
+    }
+    // Ячейка сменилась: переезд под блокировкой обоих сегментов. Запрос держит
+    // блокировки всех обходимых сегментов сразу, поэтому видит фигуру ровно в
+    // одном из них - до переезда или после.
+    fromLock.unlock();
+    Shard& to = *shards[target];
+    std::unique_lock<std::mutex> toLock(to.mutex, std::defer_lock);
+    std::lock(fromLock, toLock);
+    insert(to, id, extract(from, id));
+    it->second = target;
+}
+
+std::shared_ptr<const Figure> ShardedFigureCollection::find(uint64_t id) const {
+    Directory& entry = directoryFor(id);
+    std::lock_guard<std::mutex> directoryLock(entry.mutex);
+    auto it = entry.shard.find(id);
+    if (it == entry.shard.end()) {
+        return nullptr;
+    }
+    const Shard& shard = *shards[it->second];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.figures.at(shard.positions.at(id));
+}
+
+size_t ShardedFigureCollection::shardOf(uint64_t id) const {
+    Directory& entry = directoryFor(id);
+    std::lock_guard<std::mutex> directoryLock(entry.mutex);
+    auto it = entry.shard.find(id);
+    if (it == entry.shard.end()) {
+        throw std::out_of_range("Unknown figure id");
+    }
+    return it->second;
+}
+
+size_t ShardedFigureCollection::shardSize(size_t shard) const {
+    std::lock_guard<std::mutex> lock(shards.at(shard)->mutex);
+    return shards[shard]->ids.size();
+}
+
+size_t ShardedFigureCollection::size() const {
+    size_t total = 0;
+    for (size_t i = 0; i < shards.size(); ++i) {
+        total += shardSize(i);
+    }
+    return total;
+}
+
+std::vector<size_t> ShardedFigureCollection::candidateShards(const Query& query) const {
+    QueryConstraints constraints = query.constraints();
+    std::vector<size_t> result;
+    for (size_t s = 0; s < shards.size(); ++s) {
+        std::lock_guard<std::mutex> lock(shards[s]->mutex);
+        if (relevant(*shards[s], &constraints)) {
+            result.push_back(s);
+        }
+    }
+    return result;
+}
+
+template <typename Visit>
+void ShardedFigureCollection::scan(const QueryConstraints* constraints, Visit visit) const {
+    // Все блокировки по возрастанию номера - тот же порядок у всех запросов;
+    // setVertex берёт две через std::lock, не держа ни одной в ожидании.
+    // Ненужные сегменты отпускаются, только когда взяты все: иначе фигура
+    // могла бы переехать из ещё не взятого сегмента в уже отпущенный.
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(shards.size());
+    for (const auto& shard : shards) {
+        locks.emplace_back(shard->mutex);
+    }
+    std::vector<size_t> targets;
+    for (size_t s = 0; s < shards.size(); ++s) {
+        if (relevant(*shards[s], constraints)) {
+            targets.push_back(s);
+        } else {
+            locks[s].unlock();
+        }
+    }
+    Parallel::forBlocks(targets.size(), 1, [&](size_t worker, size_t begin, size_t end) {
+        for (size_t t = begin; t < end; ++t) {
+            visit(worker, *shards[targets[t]]);
+        }
+    });
+}
+
+std::vector<uint64_t> ShardedFigureCollection::select(const Query& query) const {
+    CompiledQuery compiled = query.compile();
+    QueryConstraints constraints = query.constraints();
+    std::vector<std::vector<uint64_t>> partial(Parallel::workerCount(shards.size(), 1));
+    scan(&constraints, [&](size_t worker, const Shard& shard) {
+        for (size_t i = 0; i < shard.ids.size(); ++i) {
+            if (compiled.matches(*shard.figures.at(i))) {
+                partial[worker].push_back(shard.ids[i]);
+            }
+        }
+    });
+    std::vector<uint64_t> result;
+    for (const auto& part : partial) {
+        result.insert(result.end(), part.begin(), part.end());
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+size_t ShardedFigureCollection::count(const Query& query) const {
+    CompiledQuery compiled = query.compile();
+    QueryConstraints constraints = query.constraints();
+    std::vector<size_t> partial(Parallel::workerCount(shards.size(), 1), 0);
+    scan(&constraints, [&](size_t worker, const Shard& shard) {
+        for (const auto& fig : shard.figures) {
+            if (compiled.matches(*fig)) {
+                ++partial[worker];
+            }
+        }
+    });
+    size_t total = 0;
+    for (size_t part : partial) {
+        total += part;
+    }
+    return total;
+}
+
+double ShardedFigureCollection::totalArea() const {
+    std::vector<double> partial(Parallel::workerCount(shards.size(), 1), 0.0);
+    scan(nullptr, [&](size_t worker, const Shard& shard) {
+        partial[worker] += shard.figures.totalArea();
+    });
+    double total = 0;
+    for (double part : partial) {
+        total += part;
+    }
+    return total;
+}
+
+FigureArray ShardedFigureCollection::snapshot() const {
+    FigureArray result;
+    for (const auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (const auto& fig : shard->figures) {
+            result.addFigure(fig);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,250 @@
+#include "sketches.h"
+#include "parallel.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+    const size_t SKETCH_BLOCK = 8192;
+}
+
+TDigest::TDigest(double compression) : compression(compression) {
+    if (compression < 10) {
+        throw std::invalid_argument("t-digest compression must be at least 10");
+    }
+}
+
+std::vector<TDigest::Centroid> TDigest::compressed(std::vector<Centroid> points) const {
+    std::sort(points.begin(), points.end(), [](const Centroid& l, const Centroid& r) { return l.mean < r.mean; });
+    std::vector<Centroid> result;
+    if (points.empty()) {
+        return result;
+    }
+    double total = 0;
+    for (const Centroid& c : points) {
+        total += c.weight;
+    }
+    Centroid current = points[0];
+    double before = 0;
+    for (size_t i = 1; i < points.size(); ++i) {
+        double proposed = current.weight + points[i].weight;
+        double q = (before + proposed / 2) / total;
+        // шкала k1 в приближении: у краёв центроиды маленькие, в середине - крупные
+        double limit = std::max(1.0, 4 * total * q * (1 - q) / compression);
+        if (proposed <= limit) {
+            current.mean += (points[i].mean - current.mean) * points[i].weight / proposed;
+            current.weight = proposed;
+        } else {
+            result.push_back(current);
+            before += current.weight;
+            current = points[i];
+        }
+    }
+    result.push_back(current);
+    return result;
+}
+
+void TDigest::flush() {
+    if (buffer.empty()) {
+        return;
+    }
+    buffer.insert(buffer.end(), centroids.begin(), centroids.end());
+    centroids = compressed(std::move(buffer));
+    buffer.clear();
+}
+
+void TDigest::add(double value, double weight) {
+    if (weight <= 0) {
+        return;
+    }
+    if (totalWeight == 0) {
+        minValue = maxValue = value;
+    } else {
+        minValue = std::min(minValue, value);
+        maxValue = std::max(maxValue, value);
+    }
+    totalWeight += weight;
+    buffer.push_back(Centroid{value, weight});
+    if (buffer.size() >= static_cast<size_t>(5 * compression)) {
+        flush();
+    }
+}
+
+void TDigest::merge(const TDigest& other) {
+    if (other.totalWeight == 0) {
+        return;
+    }
+    if (totalWeight == 0) {
+        minValue = other.minValue;
+        maxValue = other.maxValue;
+    } else {
+        minValue = std::min(minValue, other.minValue);
+        maxValue = std::max(maxValue, other.maxValue);
+    }
+    // other может оказаться *this: вставка диапазона самого растущего вектора -
+    // неопределённое поведение, поэтому сначала копируем входные центроиды
+    std::vector<Centroid> incoming = other.centroids;
+    incoming.insert(incoming.end(), other.buffer.begin(), other.buffer.end());
+    totalWeight += other.totalWeight;
+    buffer.insert(buffer.end(), incoming.begin(), incoming.end());
+    flush();
+}
+
+size_t TDigest::centroidCount() const {
+    std::vector<Centroid> all = centroids;
+    all.insert(all.end(), buffer.begin(), buffer.end());
+    return compressed(std::move(all)).size();
+}
+
+double TDigest::quantile(double q) const {
+    if (totalWeight == 0) {
+        throw std::runtime_error("Quantile of an empty t-digest");
+    }
+    q = std::max(0.0, std::min(1.0, q));
+    std::vector<Centroid> all = centroids;
+    if (!buffer.empty()) {
+        all.insert(all.end(), buffer.begin(), buffer.end());
+        all = compressed(std::move(all));
+    }
+    double target = q * totalWeight;
+    // центр i-го центроида приходится на накопленный вес before + weight / 2
+    double before = 0;
+    double previousCenter = 0, previousMean = minValue;
+    for (const Centroid& c : all) {
+        double center = before + c.weight / 2;
+        if (target < center) {
+            double span = center - previousCenter;
+            double t = span > 0 ? (target - previousCenter) / span : 0;
+            return previousMean + t * (c.mean - previousMean);
+        }
+        previousCenter = center;
+        previousMean = c.mean;
+        before += c.weight;
+    }
+    double span = totalWeight - previousCenter;
+    double t = span > 0 ? (target - previousCenter) / span : 1;
+    return previousMean + t * (maxValue - previousMean);
+}
+
+FixedHistogram::FixedHistogram(double low, double high, size_t bucketCount)
+    : low(low), high(high), buckets(bucketCount, 0) {
+    if (!(high > low) || bucketCount == 0) {
+        throw std::invalid_argument("Histogram needs low < high and at least one bucket");
+    }
+}
+
+void FixedHistogram::add(double value) {
+    if (value < low) {
+        ++underflow;
+    } else if (value >= high) {
+        ++overflow;
+    } else {
+        size_t bucket = static_cast<size_t>((value - low) / (high - low) * buckets.size());
+        ++buckets[std::min(bucket, buckets.size() - 1)];
+    }
+}
+
+void FixedHistogram::merge(const FixedHistogram& other) {
+    if (other.low != low || other.high != high || other.buckets.size() != buckets.size()) {
+        throw std::invalid_argument("Histograms have different layouts");
+    }
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        buckets[i] += other.buckets[i];
+    }
+    underflow += other.underflow;
+    overflow += other.overflow;
+}
+
+double FixedHistogram::bucketLow(size_t bucket) const {
+    return low + (high - low) * bucket / buckets.size();
+}
+
+uint64_t FixedHistogram::total() const {
+    uint64_t result = underflow + overflow;
+    for (uint64_t count : buckets) {
+        result += count;
+    }
+    return result;
+}
+
+FigureDistribution::Metric::Metric(const HistogramLayout& layout, double compression)
+    : digest(compression), histogram(layout.low, layout.high, layout.buckets) {}
+
+void FigureDistribution::Metric::add(double value) {
+    digest.add(value);
+    histogram.add(value);
+}
+
+void FigureDistribution::Metric::merge(const Metric& other) {
+    digest.merge(other.digest);
+    histogram.merge(other.histogram);
+}
+
+FigureDistribution::Entry::Entry(const HistogramLayout& areaLayout, const HistogramLayout& perimeterLayout,
+                                 double compression)
+    : area(areaLayout, compression), perimeter(perimeterLayout, compression) {}
+
+void FigureDistribution::Entry::merge(const Entry& other) {
+    area.merge(other.area);
+    perimeter.merge(other.perimeter);
+}
+
+FigureDistribution::FigureDistribution(const HistogramLayout& areaLayout, const HistogramLayout& perimeterLayout,
+                                       double compression)
+    : areaLayout(areaLayout), perimeterLayout(perimeterLayout), compression(compression),
+      all(areaLayout, perimeterLayout, compression) {}
+
+void FigureDistribution::add(const Figure& fig) {
+    double area = fig.area();
+    double perimeter = GeometryUtils::perimeter(fig);
+    all.area.add(area);
+    all.perimeter.add(perimeter);
+    auto it = byType.find(fig.typeName());
+    if (it == byType.end()) {
+        it = byType.insert(std::make_pair(std::string(fig.typeName()),
+                                          Entry(areaLayout, perimeterLayout, compression))).first;
+    }
+    it->second.area.add(area);
+    it->second.perimeter.add(perimeter);
+}
+
+void FigureDistribution::merge(const FigureDistribution& other) {
+    all.merge(other.all);
+    for (const auto& item : other.byType) {
+        auto it = byType.find(item.first);
+        if (it == byType.end()) {
+            byType.insert(item);
+        } else {
+            it->second.merge(item.second);
+        }
+    }
+}
+
+const FigureDistribution::Entry* FigureDistribution::forType(const std::string& typeName) const {
+    auto it = byType.find(typeName);
+    return it == byType.end() ? nullptr : &it->second;
+}
+
+FigureDistribution FigureDistribution::of(const FigureArray& figures, const HistogramLayout& areaLayout,
+                                          const HistogramLayout& perimeterLayout, double compression) {
+    std::vector<FigureDistribution> partial(Parallel::workerCount(figures.size(), SKETCH_BLOCK),
+                                            FigureDistribution(areaLayout, perimeterLayout, compression));
+    Parallel::forBlocks(figures.size(), SKETCH_BLOCK, [&](size_t worker, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            partial[worker].add(*figures.at(i));
+        }
+    });
+    for (size_t i = 1; i < partial.size(); ++i) {
+        partial[0].merge(partial[i]);
+    }
+    return partial[0];
+}
+
+FigureDistribution FigureDistribution::of(FigureReader& reader, const HistogramLayout& areaLayout,
+                                          const HistogramLayout& perimeterLayout, double compression) {
+    FigureDistribution result(areaLayout, perimeterLayout, compression);
+    std::shared_ptr<Figure> figure;
+    while (reader.next(figure)) {
+        result.add(*figure);
+    }
+    return result;
+}
@@ -0,0 +1,95 @@
+#include "top_k.h"
+#include "parallel.h"
+#include <algorithm>
+
+namespace {
+    const size_t TOP_K_BLOCK = 4096;
+}
+
+bool TopKAccumulator::better(const RankedFigure& a, const RankedFigure& b) const {
+    if (a.value != b.value) {
+        return largest ? a.value > b.value : a.value < b.value;
+    }
+    return a.index < b.index;
+}
+
+bool TopKAccumulator::accepts(size_t index, double value) const {
+    if (k == 0) {
+        return false;
+    }
+    if (heap.size() < k) {
+        return true;
+    }
+    RankedFigure candidate = {index, value, nullptr};
+    return better(candidate, heap.front());
+}
+
+void TopKAccumulator::offer(size_t index, double value, std::shared_ptr<const Figure> figure) {
+    if (!accepts(index, value)) {
+        return;
+    }
+    auto comparator = [this](const RankedFigure& a, const RankedFigure& b) { return better(a, b); };
+    RankedFigure entry = {index, value, std::move(figure)};
+    if (heap.size() == k) {
+        std::pop_heap(heap.begin(), heap.end(), comparator);
+        heap.back() = std::move(entry);
+    } else {
+        heap.push_back(std::move(entry));
+    }
+    std::push_heap(heap.begin(), heap.end(), comparator);
+}
+
+void TopKAccumulator::merge(const TopKAccumulator& other) {
+    for (const RankedFigure& entry : other.heap) {
+        offer(entry.index, entry.value, entry.figure);
+    }
+}
+
+std::vector<RankedFigure> TopKAccumulator::result() const {
+    std::vector<RankedFigure> sorted = heap;
+    std::sort(sorted.begin(), sorted.end(), [this](const RankedFigure& a, const RankedFigure& b) {
+        return better(a, b);
+    });
+    return sorted;
+}
+
+namespace TopK {
+    std::vector<RankedFigure> select(const FigureArray& figures, size_t k, const FigureMetric& metric, bool largest) {
+        std::vector<TopKAccumulator> partial(Parallel::workerCount(figures.size(), TOP_K_BLOCK),
+                                             TopKAccumulator(k, largest));
+        Parallel::forBlocks(figures.size(), TOP_K_BLOCK, [&](size_t worker, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                partial[worker].offer(i, metric(*figures.at(i)));
+            }
+        });
+        TopKAccumulator total(k, largest);
+        for (const auto& part : partial) {
+            total.merge(part);
+        }
+        std::vector<RankedFigure> result = total.result();
+        for (auto& entry : result) {
+            entry.figure = figures.at(entry.index);
+        }
+        return result;
+    }
+
+    std::vector<RankedFigure> select(const FigureArray& figures, size_t k, FigureKey key, bool largest) {
+        return select(figures, k, [key](const Figure& fig) { return FigureKeys::of(fig, key); }, largest);
+    }
+
+    std::vector<RankedFigure> select(FigureReader& reader, size_t k, const FigureMetric& metric, bool largest) {
+        TopKAccumulator total(k, largest);
+        std::shared_ptr<Figure> figure;
+        for (size_t index = 0; reader.next(figure); ++index) {
+            double value = metric(*figure);
+            if (total.accepts(index, value)) {
+                total.offer(index, value, figure);
+            }
+        }
+        return total.result();
+    }
+
+    std::vector<RankedFigure> select(FigureReader& reader, size_t k, FigureKey key, bool largest) {
+        return select(reader, k, [key](const Figure& fig) { return FigureKeys::of(fig, key); }, largest);
+    }
+}
@@ -1,10 +1,15 @@
 #include "trapezoid.h"
+#include "affine.h"
+#include "predicates.h"
 #include <stdexcept>
 
 void Trapezoid::validate() const {
     if (!validState) {
         throw std::runtime_error("Trapezoid is in invalid state");
     }
+    if (verified) {
+        return;
+    }
 
     for (int i = 0; i < 4; ++i) {
         if (GeometryUtils::areCollinear(vertices[i], vertices[(i + 1) % 4], vertices[(i + 2) % 4])) {
@@ -16,10 +21,10 @@ void Trapezoid::validate() const {
         const Point& a = vertices[i];
         const Point& b = vertices[(i + 1) % 4];
         const Point& c = vertices[(i + 2) % 4];
-        double cross = GeometryUtils::crossProduct(a, b, c);
+        int turn = Predicates::orientation(a, b, c);
         if (sign == 0) {
-            sign = (cross > 0) ? 1 : -1;
-        } else if ((cross > 0 && sign < 0) || (cross < 0 && sign > 0)) {
+            sign = turn;
+        } else if (turn != sign) {
             throw std::runtime_error("Invalid trapezoid: polygon is not convex");
         }
     }
@@ -42,6 +47,7 @@ Trapezoid::Trapezoid(const Point& p1, const Point& p2, const Point& p3, const Po
     vertices[3] = p4;
     validState = true;
     validate();
+    verified = true;
 }
 
 Point Trapezoid::geometricCenter() const {
@@ -86,7 +92,9 @@ void Trapezoid::read(std::istream& is) {
         vertices[i] = Point(x, y);
     }
     validState = true;
+    verified = false;
     validate();
+    verified = true;
 }
 
 std::shared_ptr<Figure> Trapezoid::clone() const {
@@ -119,6 +127,7 @@ void Trapezoid::setVertex(size_t index, const Point& p) {
     }
     vertices[index] = p;
     validState = true;
+    verified = false;
 }
 
 void Trapezoid::clearVertices() {
@@ -126,6 +135,34 @@ void Trapezoid::clearVertices() {
         vertices[i] = Point(0, 0);
     }
     validState = false;
+    verified = false;
+}
+
+void Trapezoid::transform(const AffineTransform& m) {
+    validate();
+    if (!m.isInvertible()) {
+        throw std::runtime_error("Invalid trapezoid: transform is degenerate");
+    }
+    // невырожденное аффинное преобразование сохраняет параллельность и
+    // выпуклость, а допуски проверки относительные - проверять заново незачем
+    GeometryUtils::transformPoints(vertices, VERTEX_COUNT, m);
+    verified = true;
+}
+
+bool Trapezoid::transformMayFail(const AffineTransform& m) const {
+    return !verified || !m.isInvertible();
+}
+
+Figure::CheckState Trapezoid::checkState() const {
+    if (!validState) {
+        return CheckState::EMPTY;
+    }
+    return verified ? CheckState::VERIFIED : CheckState::PENDING;
+}
+
+void Trapezoid::restoreCheckState(CheckState state) {
+    validState = state != CheckState::EMPTY;
+    verified = state == CheckState::VERIFIED;
 }
 
 Trapezoid& Trapezoid::operator=(const Trapezoid& other) {
@@ -134,6 +171,7 @@ Trapezoid& Trapezoid::operator=(const Trapezoid& other) {
             vertices[i] = other.vertices[i];
         }
         validState = other.validState;
+        verified = other.verified;
     }
     return *this;
 }
@@ -144,7 +182,9 @@ Trapezoid& Trapezoid::operator=(Trapezoid&& other) noexcept {
             vertices[i] = std::move(other.vertices[i]);
         }
         validState = other.validState;
+        verified = other.verified;
         other.validState = false;
+        other.verified = false;
     }
     return *this;
 }
\ No newline at end of file
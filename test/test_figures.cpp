@@ -3,6 +3,32 @@
 #include "trapezoid.h"
 #include "rhombus.h"
 #include "pentagon.h"
+#include "integer_figures.h"
+#include "predicates.h"
+#include "figure_value.h"
+#include "figure_array.h"
+#include "collision.h"
+#include "covered_area.h"
+#include "convex_hull.h"
+#include "kd_tree.h"
+#include "figure_order.h"
+#include "top_k.h"
+#include "sketches.h"
+#include "group_by.h"
+#include "query.h"
+#include "query_planner.h"
+#include "figure_view.h"
+#include "mapped_store.h"
+#include "durable_array.h"
+#include "edit_journal.h"
+#include "concurrent_array.h"
+#include "figure_ingest.h"
+#include "sharded_collection.h"
+#include <thread>
+#include <fstream>
+#include <random>
+#include <numeric>
+#include <cmath>
 
 TEST(FigureTest, ValidTrapezoid) {
     EXPECT_NO_THROW({
@@ -94,6 +120,1350 @@ TEST(FigureTest, PentagonStreamValidation) {
     EXPECT_THROW(ss2 >> pent2, std::runtime_error);
 }
 
+TEST(IntegerFigureTest, ValidFiguresAndExactArea) {
+    IntTrapezoid32 tr(IntPoint32(0,0), IntPoint32(4,0), IntPoint32(3,2), IntPoint32(1,2));
+    EXPECT_EQ(tr.twiceArea(), 12);
+    EXPECT_DOUBLE_EQ(tr.area(), 6.0);
+    IntRhombus64 rh(IntPoint64(0,2), IntPoint64(2,0), IntPoint64(0,-2), IntPoint64(-2,0));
+    EXPECT_EQ(rh.twiceArea(), 16);
+    IntPentagon32 pent(IntPoint32(0,2), IntPoint32(2,1), IntPoint32(1,-1), IntPoint32(-1,-1), IntPoint32(-2,1));
+    EXPECT_EQ(pent.twiceArea(), 16);
+    EXPECT_TRUE(pent.toFigure()->equals(Pentagon(Point(0,2), Point(2,1), Point(1,-1), Point(-1,-1), Point(-2,1))));
+}
+
+TEST(IntegerFigureTest, ExactPredicatesOnLargeCoordinates) {
+    // при таких координатах double теряет младшие биты, а проверки остаются точными
+    const int64_t big = int64_t(1) << 60;
+    EXPECT_NO_THROW({
+        IntTrapezoid64 tr(IntPoint64(-big,0), IntPoint64(big,0), IntPoint64(big - 1,1), IntPoint64(-big + 2,1));
+    });
+    EXPECT_THROW({ // почти вырожденная, но коллинеарная
+        IntTrapezoid64 tr(IntPoint64(0,0), IntPoint64(big,1), IntPoint64(2 * big,2), IntPoint64(0,5));
+    }, std::runtime_error);
+    EXPECT_THROW({
+        IntPentagon64 pent(IntPoint64(0,0), IntPoint64(INT64_MAX,0), IntPoint64(1,1), IntPoint64(0,2), IntPoint64(-1,1));
+    }, std::out_of_range);
+}
+
+TEST(IntegerFigureTest, InvalidIntegerFigures) {
+    EXPECT_THROW({ // параллелограмм
+        IntTrapezoid32 tr(IntPoint32(0,0), IntPoint32(2,0), IntPoint32(2,2), IntPoint32(0,2));
+    }, std::runtime_error);
+    EXPECT_THROW({
+        IntRhombus32 rh(IntPoint32(0,0), IntPoint32(3,0), IntPoint32(3,2), IntPoint32(0,2));
+    }, std::runtime_error);
+    IntPentagon32 pent;
+    std::stringstream ss("0 0 3 0 3 3 1 1 0 3"); // невыпуклый
+    EXPECT_THROW(ss >> pent, std::runtime_error);
+}
+
+TEST(PredicatesTest, ExactSignNearDegenerate) {
+    Point a(0.5, 0.5), b(12, 12), c(24, 24);
+    EXPECT_EQ(Predicates::orientation(a, b, c), 0);
+    Point above(24, std::nextafter(24.0, 25.0));
+    Point below(24, std::nextafter(24.0, 23.0));
+    EXPECT_EQ(Predicates::orientation(a, b, above), 1);
+    EXPECT_EQ(Predicates::orientation(a, b, below), -1);
+    // допуск коллинеарности относительный: сдвиг на одно ulp его не нарушает
+    EXPECT_TRUE(GeometryUtils::areCollinear(a, b, above));
+
+    // точки на прямой y = 2x с большими координатами
+    double x1 = 123456789.123, x2 = 987654321.987, x3 = 555555555.555;
+    EXPECT_TRUE(GeometryUtils::areCollinear(Point(x1, 2 * x1), Point(x2, 2 * x2), Point(x3, 2 * x3)));
+    EXPECT_TRUE(GeometryUtils::areParallel(Point(0, 0), Point(x1, 2 * x1), Point(x3, 2 * x3), Point(x2, 2 * x2)));
+}
+
+TEST(PredicatesTest, ScaleIndependentValidation) {
+    EXPECT_NO_THROW({ // малые координаты - абсолютный EPSILON здесь не работал
+        Trapezoid tr(Point(0,0), Point(4e-6,0), Point(3e-6,2e-6), Point(1e-6,2e-6));
+        Pentagon pent(Point(0,2e-6), Point(2e-6,1e-6), Point(1e-6,-1e-6), Point(-1e-6,-1e-6), Point(-2e-6,1e-6));
+    });
+    EXPECT_THROW({
+        Trapezoid tr(Point(0,0), Point(2e-6,0), Point(2e-6,2e-6), Point(0,2e-6));
+    }, std::runtime_error);
+    EXPECT_NO_THROW({ // десятичные координаты: параллельность не точна в double
+        Trapezoid tr(Point(0.1,0.1), Point(0.7,0.3), Point(0.6,0.9), Point(0.3,0.8));
+    });
+    EXPECT_NO_THROW({
+        Rhombus rh(Point(0,2e-6), Point(2e-6,0), Point(0,-2e-6), Point(-2e-6,0));
+    });
+    EXPECT_THROW({ // стороны различаются на 1e-10 - при длине 3e-6 это не ромб
+        Rhombus rh(Point(0,2e-6), Point(2e-6,0), Point(0,-2e-6), Point(-2.0001e-6,0));
+    }, std::runtime_error);
+}
+
+namespace {
+    // фигура, не помещающаяся во встроенный буфер FigureValue
+    class Polyline : public Figure {
+    public:
+        Point points[16];
+        Point geometricCenter() const override { return points[0]; }
+        double area() const override { return 0; }
+        void print(std::ostream& os) const override { os << "Polyline"; }
+        void read(std::istream&) override {}
+        std::shared_ptr<Figure> clone() const override { return std::make_shared<Polyline>(*this); }
+        bool equals(const Figure& other) const override { return dynamic_cast<const Polyline*>(&other) != nullptr; }
+        size_t vertexCount() const override { return 16; }
+        Point getVertex(size_t index) const override { return points[index]; }
+        void setVertex(size_t index, const Point& p) override { points[index] = p; }
+        void clearVertices() override {}
+    };
+}
+
+TEST(FigureValueTest, BuiltInShapesAreInline) {
+    std::vector<FigureValue> values;
+    values.push_back(Trapezoid(Point(0,0), Point(4,0), Point(3,2), Point(1,2)));
+    values.push_back(FigureValue::make<Rhombus>(Point(0,2), Point(2,0), Point(0,-2), Point(-2,0)));
+    values.emplace_back(Pentagon(Point(0,2), Point(2,1), Point(1,-1), Point(-1,-1), Point(-2,1)));
+    for (const auto& value : values) {
+        EXPECT_TRUE(value.isInline());
+    }
+    EXPECT_DOUBLE_EQ(values[0]->area(), 6.0);
+    EXPECT_DOUBLE_EQ(values[1]->area(), 8.0);
+    EXPECT_NE(values[1].as<Rhombus>(), nullptr);
+    EXPECT_EQ(values[1].as<Trapezoid>(), nullptr);
+}
+
+TEST(FigureValueTest, CopyIsDeepAndMoveEmptiesSource) {
+    FigureValue original(Trapezoid(Point(0,0), Point(4,0), Point(3,2), Point(1,2)));
+    FigureValue copy = original;
+    copy->setVertex(0, Point(-1, 0));
+    EXPECT_EQ(original->getVertex(0), Point(0, 0));
+    EXPECT_FALSE(*original == *copy);
+
+    FigureValue moved = std::move(copy);
+    EXPECT_TRUE(copy.empty());
+    EXPECT_EQ(moved->getVertex(0), Point(-1, 0));
+}
+
+TEST(FigureValueTest, OversizedFigureFallsBackToHeap) {
+    Polyline line;
+    line.points[3] = Point(7, 7);
+    FigureValue value(line);
+    EXPECT_FALSE(value.isInline());
+    FigureValue copy(value);
+    EXPECT_NE(copy.get(), value.get());
+    EXPECT_EQ(copy->getVertex(3), Point(7, 7));
+    FigureValue moved(std::move(value));
+    EXPECT_TRUE(value.empty());
+    EXPECT_EQ(moved.as<Polyline>()->points[3], Point(7, 7));
+}
+
+TEST(TransformTest, RotationKeepsFiguresValid) {
+    Trapezoid tr(Point(0,0), Point(4,0), Point(3,2), Point(1,2));
+    tr.transform(AffineTransform::rotation(0.3, Point(1, 1)));
+    EXPECT_NEAR(tr.area(), 6.0, 1e-9);
+    Rhombus rh(Point(0,2), Point(2,0), Point(0,-2), Point(-2,0));
+    rh.transform(AffineTransform::rotation(1.0).then(AffineTransform::scaling(3, 3)));
+    EXPECT_NEAR(rh.area(), 72.0, 1e-9);
+}
+
+TEST(TransformTest, InvalidatingTransformIsRejected) {
+    Rhombus rh(Point(0,2), Point(2,0), Point(0,-2), Point(-2,0));
+    EXPECT_NO_THROW(rh.transform(AffineTransform::scaling(2, 1))); // растяжение вдоль диагонали - снова ромб
+    EXPECT_THROW(rh.transform(AffineTransform(1, 0.5, 0, 1)), std::runtime_error);
+    EXPECT_EQ(rh.getVertex(1), Point(4, 0)); // откат к исходным вершинам
+    Trapezoid tr(Point(0,0), Point(4,0), Point(3,2), Point(1,2));
+    EXPECT_THROW(tr.transform(AffineTransform::scaling(0, 1)), std::runtime_error);
+    EXPECT_NO_THROW(tr.transform(AffineTransform(1, 0.5, 0, 1))); // сдвиг сохраняет трапецию
+}
+
+TEST(TransformTest, BatchTransformUpdatesMetrics) {
+    FigureArray array;
+    array.addFigure(std::make_shared<Trapezoid>(Point(0,0), Point(4,0), Point(3,2), Point(1,2)));
+    array.addFigure(std::make_shared<Rhombus>(Point(0,2), Point(2,0), Point(0,-2), Point(-2,0)));
+    array.addFigure(std::make_shared<Pentagon>(Point(0,2), Point(2,1), Point(1,-1), Point(-1,-1), Point(-2,1)));
+    std::vector<FigureMetrics> metrics = array.metrics();
+    AffineTransform m = AffineTransform::scaling(2, 2).then(AffineTransform::translation(10, -5));
+    array.transformAll(m, metrics);
+    array.transformAll(AffineTransform::rotation(0.5), metrics);
+    std::vector<FigureMetrics> fresh = array.metrics();
+    for (size_t i = 0; i < array.size(); ++i) {
+        EXPECT_NEAR(metrics[i].area, fresh[i].area, 1e-9);
+        EXPECT_NEAR(metrics[i].perimeter, fresh[i].perimeter, 1e-9);
+        EXPECT_NEAR(metrics[i].center.x, fresh[i].center.x, 1e-9);
+        EXPECT_NEAR(metrics[i].center.y, fresh[i].center.y, 1e-9);
+        EXPECT_NEAR(metrics[i].box.maxX, fresh[i].box.maxX, 1e-9);
+    }
+    EXPECT_NEAR(array.totalArea(), 4 * (6.0 + 8.0 + 8.0), 1e-9);
+}
+
+TEST(TransformTest, BatchTransformIsAllOrNothing) {
+    FigureArray array;
+    for (int i = 0; i < 199; ++i) {
+        double x = i * 0.37;
+        array.addFigure(std::make_shared<Trapezoid>(Point(x, 0.1), Point(x + 0.6, 0.3), Point(x + 0.5, 0.9), Point(x + 0.2, 0.8)));
+    }
+    array.transformAll(AffineTransform::rotation(0.3).then(AffineTransform::translation(0.1, 0.3)));
+    for (const auto& fig : array) {
+        ASSERT_NO_THROW(FigureRecords::decode(FigureRecords::encode(*fig)));
+    }
+    // Свои фигуры массив меняет на месте, общие со снимком - копирует.
+    const Figure* own = array.at(0).get();
+    array.transformAll(AffineTransform::translation(1, 0));
+    EXPECT_EQ(array.at(0).get(), own);
+    FigureArray snapshot = array;
+    array.transformAll(AffineTransform::translation(-1, 0));
+    EXPECT_NE(array.at(0).get(), own);
+    EXPECT_EQ(snapshot.at(0).get(), own);
+    EXPECT_NEAR(snapshot.at(0)->getVertex(0).x, array.at(0)->getVertex(0).x + 1, 1e-12);
+
+    array.addFigure(std::make_shared<Rhombus>(Point(0,2), Point(2,0), Point(0,-2), Point(-2,0)));
+    Point before = array.at(0)->getVertex(0);
+    EXPECT_THROW(array.transformAll(AffineTransform(1, 0.5, 0, 1)), std::runtime_error);
+    EXPECT_EQ(array.at(0)->getVertex(0), before);
+    EXPECT_EQ(array.at(199)->getVertex(1), Point(2, 0));
+}
+
+namespace {
+    std::shared_ptr<Figure> diamond(double x, double y, double r) {
+        return std::make_shared<Rhombus>(Point(x, y + r), Point(x + r, y), Point(x, y - r), Point(x - r, y));
+    }
+}
+
+TEST(CollisionTest, SeparatingAxisRejectsBoxOnlyOverlap) {
+    Rhombus a(Point(0,1), Point(1,0), Point(0,-1), Point(-1,0));
+    Rhombus b(Point(1.5,2.5), Point(2.5,1.5), Point(1.5,0.5), Point(0.5,1.5)); // рамки пересекаются, фигуры - нет
+    Trapezoid c(Point(0,0), Point(4,0), Point(3,2), Point(1,2));
+    EXPECT_FALSE(Collision::overlaps(a, b));
+    EXPECT_TRUE(Collision::overlaps(a, c));
+    Rhombus touching(Point(2,1), Point(3,0), Point(2,-1), Point(1,0));
+    EXPECT_FALSE(Collision::overlaps(a, touching));
+}
+
+TEST(CollisionTest, FindOverlapsMatchesAllPairs) {
+    FigureArray array;
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> coord(0, 50), radius(0.5, 3);
+    for (int i = 0; i < 300; ++i) {
+        array.addFigure(diamond(coord(gen), coord(gen), radius(gen)));
+    }
+    std::vector<FigurePair> expected;
+    for (size_t i = 0; i < array.size(); ++i) {
+        for (size_t j = i + 1; j < array.size(); ++j) {
+            if (Collision::overlaps(*array.at(i), *array.at(j))) {
+                expected.push_back(FigurePair(i, j));
+            }
+        }
+    }
+    EXPECT_FALSE(expected.empty());
+    EXPECT_EQ(Collision::findOverlaps(array), expected);
+}
+
+TEST(CollisionTest, IntersectionArea) {
+    Rhombus a(Point(0,1), Point(1,0), Point(0,-1), Point(-1,0));
+    Rhombus b(Point(1,1), Point(2,0), Point(1,-1), Point(0,0));
+    EXPECT_NEAR(Collision::intersectionArea(a, b), 0.5, 1e-12);
+    EXPECT_NEAR(Collision::intersectionArea(a, a), a.area(), 1e-12);
+    Trapezoid inner(Point(-0.5,-0.25), Point(0.5,-0.25), Point(0.25,0.25), Point(-0.25,0.25));
+    EXPECT_NEAR(Collision::intersectionArea(a, inner), inner.area(), 1e-12); // вложенная фигура
+    Rhombus far(Point(10,1), Point(11,0), Point(10,-1), Point(9,0));
+    EXPECT_DOUBLE_EQ(Collision::intersectionArea(a, far), 0.0);
+
+    FigureArray array;
+    array.addFigure(a.clone());
+    array.addFigure(b.clone());
+    array.addFigure(inner.clone());
+    std::vector<FigurePair> pairs = Collision::findOverlaps(array);
+    std::vector<double> areas = Collision::intersectionAreas(array, pairs);
+    ASSERT_EQ(pairs.size(), 3u);
+    EXPECT_NEAR(areas[0], 0.5, 1e-12);
+    EXPECT_NEAR(areas[1], inner.area(), 1e-12);
+}
+
+TEST(CoverageTest, CoveredAreaCountsOverlapOnce) {
+    FigureArray array;
+    array.addFigure(diamond(0, 0, 1));
+    array.addFigure(diamond(1, 0, 1));
+    array.addFigure(diamond(0.2, 0, 0.3)); // целиком внутри первого
+    array.addFigure(diamond(10, 10, 2));
+    EXPECT_NEAR(array.totalArea(), 2 + 2 + 0.18 + 8, 1e-9);
+    EXPECT_NEAR(array.coveredArea(), 2 + 2 - 0.5 + 8, 1e-9);
+    EXPECT_NEAR(array.coveredArea(true), 2 + 2 - 0.5 + 8, 1e-9);
+}
+
+TEST(CoverageTest, NestedAndEdgeSharingFigures) {
+    std::vector<ConvexPolygon> polygons;
+    for (int i = 1; i <= 40; ++i) { // вложенные и совпадающие ромбы
+        polygons.push_back(ConvexPolygon::fromFigure(*diamond(0, 0, i % 20 + 1)));
+    }
+    EXPECT_NEAR(Coverage::unionArea(polygons), 2 * 20 * 20, 1e-9);
+    polygons.clear();
+    for (int x = 0; x < 30; ++x) { // квадраты сетки с общими сторонами, повёрнутые на 45°
+        for (int y = 0; y < 30; ++y) {
+            polygons.push_back(ConvexPolygon::fromFigure(*diamond(x + y, x - y, 1)));
+        }
+    }
+    EXPECT_NEAR(Coverage::unionArea(polygons), 30 * 30 * 2, 1e-9);
+    EXPECT_NEAR(Coverage::unionArea(polygons, true), 30 * 30 * 2, 1e-9);
+}
+
+TEST(CoverageTest, ParallelStripsMatchSequential) {
+    FigureArray array;
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<double> coord(0, 40), radius(0.5, 4);
+    for (int i = 0; i < 400; ++i) {
+        array.addFigure(diamond(coord(gen), coord(gen), radius(gen)));
+    }
+    std::vector<ConvexPolygon> polygons = Collision::snapshot(array);
+    double sequential = Coverage::unionArea(polygons);
+    EXPECT_NEAR(Coverage::unionArea(polygons, true), sequential, 1e-6);
+    EXPECT_LT(sequential, array.totalArea());
+    // два непересекающихся набора: площадь объединения аддитивна
+    FigureArray shifted;
+    for (const auto& fig : array) {
+        auto copy = fig->clone();
+        copy->transform(AffineTransform::translation(100, 0));
+        shifted.addFigure(fig);
+        shifted.addFigure(copy);
+    }
+    EXPECT_NEAR(shifted.coveredArea(), 2 * sequential, 1e-6);
+}
+
+TEST(ConvexHullTest, HullOfFigures) {
+    FigureArray array;
+    array.addFigure(diamond(0, 0, 1));
+    array.addFigure(diamond(4, 0, 1));
+    array.addFigure(diamond(2, 0, 0.5));
+    ConvexHull hull = ConvexHull::of(array);
+    EXPECT_EQ(hull.size(), 6u);
+    EXPECT_NEAR(hull.area(), 4 * 2 + 2 * 1.0, 1e-12);
+    EXPECT_TRUE(hull.contains(Point(2, 0.9)));
+    EXPECT_FALSE(hull.contains(Point(2, 1.1)));
+}
+
+TEST(ConvexHullTest, IncrementalMatchesRebuild) {
+    FigureArray array;
+    ConvexHull incremental;
+    std::mt19937 gen(3);
+    std::uniform_real_distribution<double> coord(-100, 100), radius(0.5, 5);
+    for (int i = 0; i < 2000; ++i) {
+        auto fig = diamond(coord(gen), coord(gen), radius(gen));
+        array.addFigure(fig);
+        incremental.addFigure(*fig);
+    }
+    ConvexHull rebuilt = ConvexHull::of(array);
+    ASSERT_EQ(incremental.size(), rebuilt.size());
+    EXPECT_NEAR(incremental.area(), rebuilt.area(), 1e-9);
+    for (const auto& fig : array) {
+        for (size_t i = 0; i < fig->vertexCount(); ++i) {
+            EXPECT_TRUE(rebuilt.contains(fig->getVertex(i)));
+        }
+    }
+}
+
+TEST(KdTreeTest, NearestMatchesBruteForce) {
+    FigureArray array;
+    std::mt19937 gen(11);
+    std::uniform_real_distribution<double> coord(-50, 50), radius(0.2, 3);
+    for (int i = 0; i < 500; ++i) {
+        array.addFigure(diamond(coord(gen), coord(gen), radius(gen)));
+    }
+    FigureKdTree tree(array);
+    std::vector<ConvexPolygon> polygons = Collision::snapshot(array);
+    std::vector<Point> queries;
+    for (int i = 0; i < 50; ++i) {
+        queries.push_back(Point(coord(gen), coord(gen)));
+    }
+    std::vector<std::vector<FigureNeighbor>> batch = tree.nearestBatch(queries, 5);
+    for (size_t q = 0; q < queries.size(); ++q) {
+        std::vector<double> distances;
+        for (const auto& poly : polygons) {
+            distances.push_back(poly.distanceTo(queries[q]));
+        }
+        std::sort(distances.begin(), distances.end());
+        ASSERT_EQ(batch[q].size(), 5u);
+        for (size_t i = 0; i < 5; ++i) {
+            EXPECT_DOUBLE_EQ(batch[q][i].distance, distances[i]);
+        }
+    }
+}
+
+TEST(KdTreeTest, PointInsideFigureHasZeroDistance) {
+    FigureArray array;
+    array.addFigure(diamond(0, 0, 1));
+    array.addFigure(diamond(5, 0, 1));
+    FigureKdTree tree(array);
+    std::vector<FigureNeighbor> result = tree.nearest(Point(4.8, 0.1), 2);
+    ASSERT_EQ(result.size(), 2u);
+    EXPECT_EQ(result[0].index, 1u);
+    EXPECT_DOUBLE_EQ(result[0].distance, 0.0);
+    EXPECT_EQ(result[1].index, 0u);
+    EXPECT_TRUE(tree.nearest(Point(0, 0), 0).empty());
+    EXPECT_EQ(tree.nearest(Point(0, 0), 10).size(), 2u);
+}
+
+TEST(OrderTest, SortedPermutationIsStableAndMatchesSort) {
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<int> value(0, 1000);
+    std::vector<double> keys(100000);
+    for (auto& key : keys) {
+        key = value(gen);
+    }
+    std::vector<size_t> expected(keys.size());
+    std::iota(expected.begin(), expected.end(), size_t(0));
+    std::stable_sort(expected.begin(), expected.end(), [&](size_t l, size_t r) { return keys[l] > keys[r]; });
+    EXPECT_EQ(FigureKeys::sortedPermutation(keys, true), expected);
+}
+
+TEST(OrderTest, OrderedViewDoesNotReorderStorage) {
+    FigureArray array;
+    array.addFigure(diamond(0, 0, 2));
+    array.addFigure(diamond(0, 0, 1));
+    array.addFigure(diamond(10, 0, 3));
+    OrderedView byArea(array, FigureKey::Area);
+    std::vector<double> areas;
+    for (const Figure& fig : byArea) {
+        areas.push_back(fig.area());
+    }
+    EXPECT_EQ(areas, (std::vector<double>{2, 8, 18}));
+    EXPECT_EQ(byArea.indices(), (std::vector<size_t>{1, 0, 2}));
+    EXPECT_DOUBLE_EQ(array.at(0)->area(), 8);
+    OrderedView byX(array, FigureKey::CenterX, true);
+    EXPECT_EQ(byX.indexAt(0), 2u);
+    EXPECT_DOUBLE_EQ(byX.keyAt(0), 10);
+}
+
+TEST(TopKTest, LargestAndSmallestByArea) {
+    FigureArray array;
+    for (int i = 1; i <= 20; ++i) {
+        array.addFigure(diamond(i * 10, 0, (i * 7) % 20 + 1));
+    }
+    std::vector<RankedFigure> top = TopK::select(array, 3, FigureKey::Area);
+    ASSERT_EQ(top.size(), 3u);
+    EXPECT_DOUBLE_EQ(top[0].value, 2 * 20 * 20);
+    EXPECT_DOUBLE_EQ(top[1].value, 2 * 19 * 19);
+    EXPECT_EQ(top[0].figure, array.at(top[0].index));
+    std::vector<RankedFigure> bottom = TopK::select(array, 2, FigureKey::Area, false);
+    EXPECT_DOUBLE_EQ(bottom[0].value, 2.0);
+    EXPECT_TRUE(TopK::select(array, 0, FigureKey::Area).empty());
+    EXPECT_EQ(TopK::select(array, 100, FigureKey::Area).size(), 20u);
+}
+
+TEST(TopKTest, StreamingFromReader) {
+    std::stringstream ss("Rhombus 0 2 2 0 0 -2 -2 0\n"
+                         "Trapezoid 0 0 4 0 3 2 1 2\n"
+                         "Pentagon 0 2 2 1 1 -1 -1 -1 -2 1\n"
+                         "Rhombus 0 1 1 0 0 -1 -1 0\n");
+    FigureReader reader(ss);
+    std::vector<RankedFigure> top = TopK::select(reader, 2, FigureKey::Area);
+    ASSERT_EQ(top.size(), 2u);
+    EXPECT_EQ(top[0].index, 0u); // площадь 8, при равенстве - меньший номер
+    EXPECT_EQ(top[1].index, 2u);
+    EXPECT_TRUE(top[1].figure->equals(Pentagon(Point(0,2), Point(2,1), Point(1,-1), Point(-1,-1), Point(-2,1))));
+    EXPECT_EQ(reader.position(), 4u);
+
+    std::stringstream bad("Hexagon 0 0");
+    FigureReader badReader(bad);
+    std::shared_ptr<Figure> fig;
+    EXPECT_THROW(badReader.next(fig), std::runtime_error);
+}
+
+TEST(SketchTest, TDigestQuantilesAndMerge) {
+    std::mt19937 gen(13);
+    std::uniform_real_distribution<double> value(0, 1000);
+    TDigest left, right;
+    std::vector<double> exact;
+    for (int i = 0; i < 50000; ++i) {
+        double v = value(gen);
+        exact.push_back(v);
+        (i % 2 ? left : right).add(v);
+    }
+    left.merge(right);
+    std::sort(exact.begin(), exact.end());
+    EXPECT_DOUBLE_EQ(left.count(), 50000);
+    EXPECT_LT(left.centroidCount(), 1000u);
+    for (double q : {0.01, 0.5, 0.99}) {
+        EXPECT_NEAR(left.quantile(q), exact[static_cast<size_t>(q * exact.size())], 5.0);
+    }
+    EXPECT_DOUBLE_EQ(left.quantile(0), exact.front());
+    EXPECT_DOUBLE_EQ(left.quantile(1), exact.back());
+}
+
+TEST(SketchTest, TDigestMergesWithItself) {
+    TDigest digest;
+    for (int i = 1; i <= 1000; ++i) {
+        digest.add(i);
+    }
+    double median = digest.quantile(0.5);
+    digest.merge(digest);
+    EXPECT_DOUBLE_EQ(digest.count(), 2000);
+    EXPECT_NEAR(digest.quantile(0.5), median, 5.0);
+    EXPECT_DOUBLE_EQ(digest.quantile(0), 1);
+    EXPECT_DOUBLE_EQ(digest.quantile(1), 1000);
+}
+
+TEST(SketchTest, HistogramMergeRequiresSameLayout) {
+    FixedHistogram a(0, 10, 5), b(0, 10, 5), c(0, 20, 5);
+    a.add(1);
+    a.add(-1);
+    b.add(9.5);
+    b.add(10);
+    a.merge(b);
+    EXPECT_EQ(a.count(0), 1u);
+    EXPECT_EQ(a.count(4), 1u);
+    EXPECT_EQ(a.underflowCount(), 1u);
+    EXPECT_EQ(a.overflowCount(), 1u);
+    EXPECT_EQ(a.total(), 4u);
+    EXPECT_THROW(a.merge(c), std::invalid_argument);
+}
+
+TEST(SketchTest, DistributionPerType) {
+    FigureArray array;
+    for (int i = 1; i <= 100; ++i) {
+        array.addFigure(diamond(i * 10, 0, 1));
+    }
+    array.addFigure(std::make_shared<Trapezoid>(Point(0,0), Point(4,0), Point(3,2), Point(1,2)));
+    HistogramLayout areaLayout = {0, 10, 10};
+    HistogramLayout perimeterLayout = {0, 20, 10};
+    FigureDistribution dist = FigureDistribution::of(array, areaLayout, perimeterLayout);
+    EXPECT_DOUBLE_EQ(dist.overall().area.digest.count(), 101);
+    ASSERT_NE(dist.forType("Rhombus"), nullptr);
+    EXPECT_DOUBLE_EQ(dist.forType("Rhombus")->area.digest.quantile(0.5), 2.0);
+    EXPECT_EQ(dist.forType("Trapezoid")->area.histogram.count(6), 1u);
+    EXPECT_EQ(dist.forType("Pentagon"), nullptr);
+
+    std::stringstream ss("Rhombus 0 1 1 0 0 -1 -1 0 Trapezoid 0 0 4 0 3 2 1 2");
+    FigureReader reader(ss);
+    FigureDistribution streamed = FigureDistribution::of(reader, areaLayout, perimeterLayout);
+    EXPECT_DOUBLE_EQ(streamed.overall().area.digest.max(), 6.0);
+}
+
+TEST(GroupByTest, AggregatesPerTypeAndTag) {
+    FigureArray array;
+    array.addFigure(diamond(0, 0, 1));
+    array.addFigure(diamond(10, 0, 2));
+    array.addFigure(std::make_shared<Trapezoid>(Point(0,0), Point(4,0), Point(3,2), Point(1,2)));
+    array.addFigure(diamond(-5, 5, 1));
+    GroupByResult result = GroupBy::byType(array);
+    ASSERT_EQ(result.size(), 2u);
+    EXPECT_EQ(result[0].first.type, "Rhombus");
+    const GroupStats* rhombi = result.find("Rhombus");
+    ASSERT_NE(rhombi, nullptr);
+    EXPECT_EQ(rhombi->count, 3u);
+    EXPECT_DOUBLE_EQ(rhombi->totalArea, 12);
+    EXPECT_DOUBLE_EQ(rhombi->meanArea(), 4);
+    EXPECT_DOUBLE_EQ(rhombi->maxArea, 8);
+    EXPECT_DOUBLE_EQ(rhombi->extent.minX, -6);
+    EXPECT_DOUBLE_EQ(rhombi->extent.maxY, 6);
+    EXPECT_EQ(result.find("Pentagon"), nullptr);
+
+    GroupByResult tagged = GroupBy::byType(array, Aggregate::COUNT,
+        [](size_t, const Figure& fig) { return fig.geometricCenter().x >= 0 ? 1 : 0; });
+    EXPECT_EQ(tagged.size(), 3u);
+    EXPECT_EQ(tagged.find("Rhombus", 1)->count, 2u);
+    EXPECT_EQ(tagged.find("Rhombus", 0)->count, 1u);
+    EXPECT_DOUBLE_EQ(tagged.find("Rhombus", 1)->totalArea, 0); // площадь не запрашивалась
+}
+
+TEST(QueryTest, ParsedAndBuiltQueriesAgree) {
+    FigureArray array;
+    array.addFigure(diamond(0, 0, 1));
+    array.addFigure(diamond(50, 50, 4));
+    array.addFigure(diamond(500, 500, 4));
+    array.addFigure(std::make_shared<Trapezoid>(Point(0,0), Point(40,0), Point(30,20), Point(10,20)));
+    CompiledQuery parsed = Query::parse("type == Rhombus && area > 10 && bbox intersects [0, 0, 100, 100]").compile();
+    CompiledQuery built = (Q::type("Rhombus") && Q::area() > 10 &&
+                           Q::bboxIntersects(BoundingBox(0, 0, 100, 100))).compile();
+    EXPECT_EQ(parsed.select(array), std::vector<size_t>({1}));
+    EXPECT_EQ(built.select(array), std::vector<size_t>({1}));
+
+    EXPECT_EQ(Query::parse("!(type != Trapezoid) || x >= 500").compile().select(array),
+              std::vector<size_t>({2, 3}));
+    EXPECT_EQ(Query::parse("bbox within [-1, -1, 60, 60] && perimeter < 100").compile().count(array), 2u);
+    EXPECT_EQ(Query().compile().count(array), 4u);
+    EXPECT_THROW(Query::parse("area >"), std::invalid_argument);
+    EXPECT_THROW(Query::parse("colour == red"), std::invalid_argument);
+    EXPECT_THROW(Query::parse("area > 1 )"), std::invalid_argument);
+}
+
+TEST(QueryTest, ParallelSelectKeepsOrder) {
+    FigureArray array;
+    for (int i = 0; i < 20000; ++i) {
+        array.addFigure(diamond(i, 0, 1 + i % 3));
+    }
+    CompiledQuery query = (Q::area() >= 8 && Q::x() < 15000).compile();
+    std::vector<size_t> selected = query.select(array);
+    ASSERT_EQ(selected.size(), query.count(array));
+    EXPECT_EQ(selected.size(), 10000u);
+    EXPECT_TRUE(std::is_sorted(selected.begin(), selected.end()));
+    for (size_t index : selected) {
+        EXPECT_NE(index % 3, 0u);
+    }
+}
+
+TEST(QueryPlannerTest, ChoosesAccessPathBySelectivity) {
+    FigureArray array;
+    for (int i = 0; i < 40000; ++i) {
+        array.addFigure(diamond((i % 200) * 10, (i / 200) * 10, 1 + i % 4));
+    }
+    array.addFigure(std::make_shared<Trapezoid>(Point(0,0), Point(4,0), Point(3,2), Point(1,2)));
+    array.addFigure(diamond(1000, 1000, 20));
+    QueryPlanner planner(array);
+    struct Case {
+        const char* text;
+        AccessPath path;
+    } cases[] = {
+        {"bbox intersects [100, 100, 120, 120]", AccessPath::SpatialIndex},
+        {"area > 100", AccessPath::AreaIndex},
+        {"type == Trapezoid && area > 1", AccessPath::TypeIndex},
+        {"area > 1", AccessPath::FullScan},
+        {"area > 31 && bbox intersects [0, 0, 1000, 1000]", AccessPath::ColumnScan},
+        {"bbox intersects [100, 100, 120, 120] || area > 31", AccessPath::FullScan},
+    };
+    // Два непересекающихся окна: большой ромб задевает оба.
+    Query disjoint = Query::parse("bbox intersects [975, 975, 985, 985] && bbox intersects [1015, 1015, 1025, 1025]");
+    std::vector<size_t> expected = disjoint.compile().select(array);
+    ASSERT_EQ(expected.size(), 1u);
+    EXPECT_EQ(planner.execute(disjoint), expected) << planner.plan(disjoint).describe();
+    for (const Case& c : cases) {
+        Query query = Query::parse(c.text);
+        QueryPlan plan = planner.plan(query);
+        EXPECT_EQ(plan.path, c.path) << c.text << " -> " << plan.describe();
+        EXPECT_EQ(planner.execute(query, plan), query.compile().select(array)) << c.text;
+    }
+}
+
+TEST(ViewTest, StagesFuseWithoutCopies) {
+    FigureArray array;
+    array.addFigure(diamond(0, 0, 1));
+    array.addFigure(std::make_shared<Trapezoid>(Point(0,0), Point(4,0), Point(3,2), Point(1,2)));
+    array.addFigure(diamond(5, 0, 3));
+    array.addFigure(diamond(9, 0, 2));
+    array.addFigure(diamond(20, 0, 4));
+    long useCount = array.at(2).use_count();
+
+    int evaluated = 0;
+    auto large = Views::all(array).byType<Rhombus>().filter([&evaluated](const Rhombus& r) {
+        ++evaluated;
+        return r.area() > 5;
+    });
+    EXPECT_EQ(evaluated, 0);
+    std::vector<FigureMetrics> metrics = large.transform(FigureMetrics::of).take(2).toVector();
+    ASSERT_EQ(metrics.size(), 2u);
+    EXPECT_DOUBLE_EQ(metrics[0].area, 18);
+    EXPECT_DOUBLE_EQ(metrics[1].center.x, 9);
+    EXPECT_EQ(evaluated, 3); // четвёртый ромб не проверялся
+    EXPECT_EQ(array.at(2).use_count(), useCount);
+
+    EXPECT_EQ(large.count(), 3u);
+    EXPECT_EQ(Views::all(array).byType<Trapezoid>().count(), 1u);
+    EXPECT_EQ(Views::all(array).take(0).count(), 0u);
+    EXPECT_EQ(Views::all(array).take(10).count(), 5u);
+    std::vector<const Figure*> picked = Views::select(array, {4, 0}).toVector();
+    ASSERT_EQ(picked.size(), 2u);
+    EXPECT_EQ(picked[0], array.at(4).get());
+
+    OrderedView byArea(array, FigureKey::Area, true);
+    double total = 0;
+    for (double area : Views::all(byArea).take(2).transform([](const Figure& f) { return f.area(); })) {
+        total += area;
+    }
+    EXPECT_DOUBLE_EQ(total, 32 + 18);
+}
+
+TEST(ViewTest, RangeOfFigureValues) {
+    std::vector<Trapezoid> values;
+    values.emplace_back(Point(0,0), Point(4,0), Point(3,2), Point(1,2));
+    values.emplace_back(Point(0,0), Point(8,0), Point(6,4), Point(2,4));
+    std::vector<const Figure*> large = Views::all(values).filter([](const Figure& f) { return f.area() > 10; }).toVector();
+    ASSERT_EQ(large.size(), 1u);
+    EXPECT_EQ(large[0], &values[1]);
+    EXPECT_EQ(Views::all(values).byType<Trapezoid>().count(), 2u);
+}
+
+TEST(MappedStoreTest, ReopensWhatWasAppended) {
+    std::string path = testing::TempDir() + "figures_mapped_store.bin";
+    FigureArray array;
+    array.addFigure(std::make_shared<Trapezoid>(Point(0,0), Point(4,0), Point(3,2), Point(1,2)));
+    array.addFigure(diamond(5, 5, 2));
+    array.addFigure(std::make_shared<Pentagon>(Point(0,0), Point(2,0), Point(3,2), Point(1,4), Point(-1,2)));
+    {
+        MappedFigureStore store = MappedFigureStore::create(path, 2);
+        store.append(array);
+        EXPECT_EQ(store.size(), 3u);
+        EXPECT_GE(store.capacity(), 3u);
+        store.sync();
+        store.append(*diamond(0, 0, 1));
+    }
+    MappedFigureStore store = MappedFigureStore::open(path);
+    ASSERT_EQ(store.size(), 4u);
+    for (size_t i = 0; i < array.size(); ++i) {
+        EXPECT_DOUBLE_EQ(store.record(i).area(), array.at(i)->area());
+        EXPECT_TRUE(store.figure(i)->equals(*array.at(i)));
+    }
+    EXPECT_STREQ(store.figure(1)->typeName(), "Rhombus");
+    EXPECT_DOUBLE_EQ(store.end()[-1].bounds().maxX, 1);
+    EXPECT_THROW(store.record(4), std::out_of_range);
+
+    std::ofstream(path) << "Trapezoid 0 0 4 0 3 2 1 2";
+    EXPECT_THROW(MappedFigureStore::open(path), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(DurableArrayTest, ReplaysLogAndCompacts) {
+    std::string dir = testing::TempDir() + "figures_durable_test";
+    std::remove((dir + "/snapshot.bin").c_str());
+    for (int segment = 1; segment < 1000; ++segment) {
+        std::remove((dir + "/wal-" + std::to_string(segment) + ".log").c_str());
+    }
+    {
+        DurableFigureArray store(dir);
+        store.addFigure(diamond(0, 0, 1));
+        store.addFigure(std::make_shared<Trapezoid>(Point(0,0), Point(4,0), Point(3,2), Point(1,2)));
+        store.addFigure(diamond(10, 0, 2));
+        store.removeFigure(0);
+        store.removeFigure(7); // не существует - в журнал не попадает
+        store.setVertex(0, 2, Point(3.5, 2));
+        store.commit();
+    }
+    {
+        DurableFigureArray store(dir);
+        ASSERT_EQ(store.array().size(), 2u);
+        EXPECT_EQ(store.array().at(0)->getVertex(2), Point(3.5, 2));
+        EXPECT_STREQ(store.array().at(1)->typeName(), "Rhombus");
+        store.compact();
+        EXPECT_EQ(store.logSize(), 0u);
+        store.addFigure(diamond(0, 20, 3));
+        store.commit();
+    }
+    // Оборванная последняя запись отбрасывается.
+    {
+        std::ofstream tail(dir + "/wal-2.log", std::ios::binary | std::ios::app);
+        tail.write("\x30\x00\x00\x00garbage", 11);
+    }
+    DurableFigureArray store(dir);
+    ASSERT_EQ(store.array().size(), 3u);
+    EXPECT_DOUBLE_EQ(store.array().at(2)->area(), 18);
+    EXPECT_DOUBLE_EQ(store.array().totalArea(), 6.5 + 8 + 18);
+}
+
+TEST(DurableArrayTest, ReopensTransformedFigures) {
+    std::string dir = testing::TempDir() + "figures_durable_transformed";
+    std::remove((dir + "/snapshot.bin").c_str());
+    for (int segment = 1; segment < 1000; ++segment) {
+        std::remove((dir + "/wal-" + std::to_string(segment) + ".log").c_str());
+    }
+    AffineTransform m = AffineTransform::rotation(0.3).then(AffineTransform::translation(0.1, 0.3));
+    auto rotated = std::make_shared<Trapezoid>(Point(0.1,0.1), Point(0.7,0.3), Point(0.6,0.9), Point(0.3,0.8));
+    rotated->transform(m);
+    {
+        DurableFigureArray store(dir);
+        store.addFigure(rotated);
+        store.addFigure(diamond(0, 0, 1));
+        store.setVertex(1, 0, Point(0, 5)); // ромб больше не ромб - проверка отложена
+        store.commit();
+    }
+    for (int pass = 0; pass < 2; ++pass) {
+        DurableFigureArray store(dir);
+        ASSERT_EQ(store.array().size(), 2u);
+        EXPECT_EQ(store.array().at(0)->getVertex(2), rotated->getVertex(2));
+        EXPECT_NEAR(store.array().at(0)->area(), rotated->area(), 1e-12);
+        EXPECT_THROW(store.array().at(1)->area(), std::runtime_error);
+        store.compact(); // второй проход читает снимок
+    }
+}
+
+TEST(DurableArrayTest, KeepsOwnCopiesAndCheckState) {
+    std::string dir = testing::TempDir() + "figures_durable_state";
+    std::remove((dir + "/snapshot.bin").c_str());
+    for (int segment = 1; segment < 1000; ++segment) {
+        std::remove((dir + "/wal-" + std::to_string(segment) + ".log").c_str());
+    }
+    auto caller = std::make_shared<Trapezoid>(Point(0,0), Point(4,0), Point(3,2), Point(1,2));
+    auto pending = std::make_shared<Trapezoid>(Point(0,0), Point(4,0), Point(3,2), Point(1,2));
+    pending->setVertex(2, Point(3, 5)); // проверка отложена, фигура уже неверна
+    std::vector<uint16_t> states;
+    {
+        DurableFigureArray store(dir);
+        store.addFigure(caller);
+        caller->setVertex(2, Point(100, 100)); // мимо журнала - массив не видит
+        store.addFigure(pending);
+        store.addFigure(std::make_shared<Rhombus>());
+        EXPECT_EQ(store.array().at(0)->getVertex(2), Point(3, 2));
+        for (const auto& fig : store.array()) {
+            states.push_back(FigureRecords::encode(*fig).check);
+        }
+        store.commit();
+    }
+    EXPECT_EQ(states, std::vector<uint16_t>({1, 0, 2}));
+    for (int pass = 0; pass < 2; ++pass) {
+        DurableFigureArray store(dir);
+        ASSERT_EQ(store.array().size(), 3u);
+        for (size_t i = 0; i < 3; ++i) {
+            EXPECT_EQ(FigureRecords::encode(*store.array().at(i)).check, states[i]);
+        }
+        EXPECT_DOUBLE_EQ(store.array().at(0)->area(), 6);
+        EXPECT_THROW(store.array().at(1)->area(), std::runtime_error);
+        EXPECT_THROW(store.array().at(2)->area(), std::runtime_error);
+        store.compact(); // второй проход читает снимок
+    }
+}
+
+TEST(DurableArrayTest, ConcurrentCommitsAreGrouped) {
+    std::string dir = testing::TempDir() + "figures_durable_group";
+    std::remove((dir + "/snapshot.bin").c_str());
+    for (int segment = 1; segment < 1000; ++segment) {
+        std::remove((dir + "/wal-" + std::to_string(segment) + ".log").c_str());
+    }
+    {
+        DurableFigureArray store(dir, 4096);
+        std::vector<std::thread> writers;
+        for (int t = 0; t < 4; ++t) {
+            writers.emplace_back([&store, t]() {
+                for (int i = 0; i < 50; ++i) {
+                    store.addFigure(diamond(t * 100 + i, 0, 1));
+                    store.commit();
+                }
+            });
+        }
+        for (auto& writer : writers) {
+            writer.join();
+        }
+        store.waitForCheckpoint();
+        CheckpointReport report = store.checkpointReport();
+        EXPECT_GT(report.sequence, 0u); // контрольная точка запускалась сама
+        EXPECT_TRUE(report.error.empty());
+    }
+    DurableFigureArray store(dir);
+    EXPECT_EQ(store.array().size(), 200u);
+}
+
+TEST(DurableArrayTest, CheckpointRunsWhileMutating) {
+    std::string dir = testing::TempDir() + "figures_durable_checkpoint";
+    std::remove((dir + "/snapshot.bin").c_str());
+    for (int segment = 1; segment < 10; ++segment) {
+        std::remove((dir + "/wal-" + std::to_string(segment) + ".log").c_str());
+    }
+    {
+        DurableFigureArray store(dir);
+        store.addFigure(std::make_shared<Trapezoid>(Point(0,0), Point(4,0), Point(3,2), Point(1,2)));
+        for (int i = 1; i < 20000; ++i) {
+            store.addFigure(diamond(i, 0, 1));
+        }
+        ASSERT_TRUE(store.startCheckpoint());
+        // Изменения во время записи снимка в него не попадают.
+        store.setVertex(0, 2, Point(3.5, 2));
+        store.removeFigure(1);
+        store.addFigure(diamond(0, 50, 2));
+        store.commit();
+        store.waitForCheckpoint();
+        CheckpointReport report = store.checkpointReport();
+        EXPECT_FALSE(report.running);
+        EXPECT_EQ(report.total, 20000u);
+        EXPECT_EQ(report.written, 20000u);
+        EXPECT_TRUE(report.error.empty());
+        EXPECT_EQ(report.sequence, 20000u);
+        EXPECT_LE(report.pauseMillis, report.durationMillis);
+
+        MappedFigureStore snapshot = MappedFigureStore::open(dir + "/snapshot.bin");
+        EXPECT_EQ(snapshot.size(), 20000u);
+        EXPECT_EQ(snapshot.record(0).vertices[2], Point(3, 2));
+    }
+    DurableFigureArray store(dir);
+    ASSERT_EQ(store.array().size(), 20000u);
+    EXPECT_EQ(store.array().at(0)->getVertex(2), Point(3.5, 2));
+    EXPECT_EQ(store.array().at(1)->geometricCenter(), Point(2, 0));
+    EXPECT_EQ(store.array().at(19999)->geometricCenter(), Point(0, 50));
+}
+
+TEST(DurableArrayTest, EditsRaceWithCheckpointSafely) {
+    // Правки на месте после окончания контрольной точки не должны
+    // пересекаться с её чтением фигур (проверяется под ThreadSanitizer).
+    std::string dir = testing::TempDir() + "figures_durable_race";
+    std::remove((dir + "/snapshot.bin").c_str());
+    for (int segment = 1; segment < 1000; ++segment) {
+        std::remove((dir + "/wal-" + std::to_string(segment) + ".log").c_str());
+    }
+    const size_t count = 3000;
+    {
+        DurableFigureArray store(dir);
+        for (size_t i = 0; i < count; ++i) {
+            store.addFigure(std::make_shared<Trapezoid>(Point(0,0), Point(4,0), Point(3,2), Point(1,2)));
+        }
+        for (int round = 0; round < 8; ++round) {
+            store.startCheckpoint();
+            for (size_t i = 0; i < count; ++i) {
+                store.setVertex(i, 2, Point(round % 2 ? 3 : 3.5, 2));
+            }
+        }
+        store.waitForCheckpoint();
+        EXPECT_TRUE(store.checkpointReport().error.empty());
+        store.commit();
+    }
+    DurableFigureArray store(dir);
+    ASSERT_EQ(store.array().size(), count);
+    EXPECT_EQ(store.array().at(count - 1)->getVertex(2), Point(3, 2));
+}
+
+TEST(EditJournalTest, UndoesAndRedoesSteps) {
+    FigureArray array;
+    EditJournal journal(array);
+    journal.addFigure(std::make_shared<Trapezoid>(Point(0,0), Point(4,0), Point(3,2), Point(1,2)));
+    journal.addFigure(diamond(10, 0, 1));
+    journal.addFigure(diamond(20, 0, 2));
+    journal.setVertex(0, 2, Point(3.5, 2));
+    journal.removeFigure(1);
+    journal.moveFigure(1, 0);
+    ASSERT_EQ(array.size(), 2u);
+    EXPECT_EQ(array.at(0)->geometricCenter(), Point(20, 0));
+    EXPECT_DOUBLE_EQ(array.at(1)->area(), 6.5); // остальные сдвинулись, пустых мест нет
+    EXPECT_DOUBLE_EQ(array.totalArea(), 14.5);
+
+    ASSERT_TRUE(journal.undo()); // перемещение - один шаг
+    EXPECT_DOUBLE_EQ(array.at(0)->area(), 6.5);
+    EXPECT_DOUBLE_EQ(array.at(1)->area(), 8);
+    ASSERT_TRUE(journal.undo());
+    ASSERT_EQ(array.size(), 3u);
+    EXPECT_EQ(array.at(1)->geometricCenter(), Point(10, 0));
+    ASSERT_TRUE(journal.undo());
+    EXPECT_EQ(array.at(0)->getVertex(2), Point(3, 2));
+    ASSERT_TRUE(journal.redo());
+    EXPECT_EQ(array.at(0)->getVertex(2), Point(3.5, 2));
+
+    journal.removeFigure(0); // новая правка отменяет возможность повтора
+    EXPECT_FALSE(journal.canRedo());
+    while (journal.undo()) {
+    }
+    EXPECT_EQ(array.size(), 0u);
+    while (journal.redo()) {
+    }
+    ASSERT_EQ(array.size(), 2u);
+    EXPECT_EQ(array.at(0)->geometricCenter(), Point(10, 0));
+
+    // Перемещение за пределы массива отклоняется целиком.
+    journal.addFigure(std::make_shared<Polyline>());
+    EXPECT_THROW(journal.moveFigure(2, 3), std::out_of_range);
+    journal.moveFigure(2, 0);
+    EXPECT_STREQ(array.at(0)->typeName(), "Figure");
+    EXPECT_NO_THROW(journal.beginStep());
+    journal.endStep();
+    ASSERT_TRUE(journal.undo());
+    EXPECT_EQ(array.at(0)->geometricCenter(), Point(10, 0));
+    ASSERT_TRUE(journal.undo());
+    EXPECT_EQ(array.size(), 2u);
+}
+
+TEST(EditJournalTest, ForgetsOldestStepsOverBudget) {
+    FigureArray array;
+    EditJournal journal(array, 4096);
+    for (int i = 0; i < 1000; ++i) {
+        journal.addFigure(diamond(i, 0, 1));
+    }
+    EXPECT_LE(journal.memoryUsed(), 4096u);
+    size_t undone = 0;
+    while (journal.undo()) {
+        ++undone;
+    }
+    EXPECT_GT(undone, 0u);
+    EXPECT_LT(undone, 1000u);
+    EXPECT_EQ(array.size(), 1000u - undone);
+}
+
+TEST(CopyOnWriteTest, SnapshotsShareUntouchedFigures) {
+    FigureArray array;
+    for (int i = 0; i < 2500; ++i) {
+        array.addFigure(diamond(i, 0, 1));
+    }
+    FigureArray snapshot = array;
+    EXPECT_EQ(snapshot.at(10).get(), array.at(10).get());
+
+    array.addFigure(std::make_shared<Trapezoid>(Point(0,0), Point(4,0), Point(3,2), Point(1,2)));
+    array.setVertex(2500, 2, Point(3.5, 2));
+    array.removeFigure(5);
+    array.insertFigure(1500, diamond(-1, -1, 2));
+    std::vector<FigureMetrics> metrics = array.metrics();
+    array.transformAll(AffineTransform::translation(0, 1), metrics);
+
+    ASSERT_EQ(snapshot.size(), 2500u);
+    for (size_t i = 0; i < snapshot.size(); ++i) {
+        ASSERT_EQ(snapshot.at(i)->geometricCenter(), Point(i, 0)) << i;
+    }
+    ASSERT_EQ(array.size(), 2501u);
+    EXPECT_EQ(array.at(5)->geometricCenter(), Point(6, 1));
+    EXPECT_EQ(array.at(1500)->geometricCenter(), Point(-1, 0));
+    EXPECT_EQ(array.at(1501)->geometricCenter(), Point(1501, 1));
+    EXPECT_EQ(metrics[1501].center, Point(1501, 1));
+    EXPECT_EQ(array.at(2500)->getVertex(2), Point(3.5, 3));
+}
+
+TEST(CopyOnWriteTest, ConstFiguresAreNeverWrittenInPlace) {
+    FigureArray array;
+    std::shared_ptr<const Figure> fixed = std::make_shared<const Trapezoid>(Point(0,0), Point(4,0), Point(3,2), Point(1,2));
+    const Figure* original = fixed.get();
+    array.addFigure(std::move(fixed)); // массив - единственный владелец
+    array.setVertex(0, 2, Point(3.5, 2));
+    const Figure* copy = array.at(0).get();
+    EXPECT_NE(copy, original);
+    array.setVertex(0, 3, Point(0.5, 2)); // свою копию массив меняет на месте
+    EXPECT_EQ(array.at(0).get(), copy);
+    EXPECT_DOUBLE_EQ(array.at(0)->area(), 7);
+}
+
+TEST(CopyOnWriteTest, EditsMatchPlainVector) {
+    std::mt19937 rng(7);
+    FigureArray array;
+    std::vector<double> model;
+    std::vector<FigureArray> snapshots;
+    std::vector<std::vector<double>> expected;
+    for (int step = 0; step < 6000; ++step) {
+        size_t size = model.size();
+        int op = rng() % 4;
+        if (op < 2 || size == 0) {
+            double x = step;
+            size_t at = size == 0 ? 0 : rng() % (size + 1);
+            array.insertFigure(at, diamond(x, 0, 1));
+            model.insert(model.begin() + at, x);
+        } else if (op == 2) {
+            size_t at = rng() % size;
+            array.removeFigure(at);
+            model.erase(model.begin() + at);
+        } else {
+            size_t at = rng() % size;
+            array.replaceFigure(at, diamond(-step, 0, 1));
+            model[at] = -step;
+        }
+        if (step % 1000 == 0) {
+            snapshots.push_back(array);
+            expected.push_back(model);
+        }
+    }
+    ASSERT_EQ(array.size(), model.size());
+    for (size_t i = 0; i < model.size(); ++i) {
+        ASSERT_DOUBLE_EQ(array.at(i)->geometricCenter().x, model[i]);
+    }
+    for (size_t k = 0; k < snapshots.size(); ++k) {
+        ASSERT_EQ(snapshots[k].size(), expected[k].size());
+        for (size_t i = 0; i < expected[k].size(); ++i) {
+            ASSERT_DOUBLE_EQ(snapshots[k].at(i)->geometricCenter().x, expected[k][i]);
+        }
+    }
+}
+
+TEST(EpochTest, RemovedFigureLivesWhilePinned) {
+    ConcurrentFigureArray array;
+    std::shared_ptr<Figure> fig = diamond(0, 0, 1);
+    std::weak_ptr<Figure> watch = fig;
+    array.addFigure(std::move(fig));
+    array.addFigure(diamond(5, 0, 1));
+    {
+        auto view = array.read();
+        array.removeFigure(0);
+        array.reclaim();
+        EXPECT_FALSE(watch.expired());
+        ASSERT_EQ(view->size(), 2u);
+        EXPECT_EQ(view->at(0)->geometricCenter(), Point(0, 0));
+        EXPECT_EQ(array.read()->size(), 1u);
+    }
+    array.reclaim();
+    EXPECT_TRUE(watch.expired());
+    EXPECT_EQ(array.pendingVersions(), 0u);
+}
+
+TEST(EpochTest, ReadersScanWhileWriterRemoves) {
+    ConcurrentFigureArray array;
+    array.update([](FigureArray& figures) {
+        for (int i = 0; i < 3000; ++i) {
+            figures.addFigure(diamond(i, 0, 1));
+        }
+    });
+    std::atomic<bool> done(false);
+    std::atomic<size_t> scans(0);
+    std::atomic<size_t> errors(0);
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&]() {
+            while (!done.load()) {
+                auto view = array.read();
+                double last = -1;
+                for (const auto& fig : *view) {
+                    double x = fig->geometricCenter().x;
+                    if (fig->area() != 2 || x <= last) {
+                        ++errors;
+                    }
+                    last = x;
+                }
+                ++scans;
+            }
+        });
+    }
+    while (scans.load() == 0) {
+        std::this_thread::yield();
+    }
+    for (int i = 0; i < 1000; ++i) {
+        array.removeFigure(i % 7);
+    }
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(errors.load(), 0u);
+    EXPECT_EQ(array.read()->size(), 2000u);
+    array.reclaim();
+    EXPECT_EQ(array.pendingVersions(), 0u);
+}
+
+TEST(VersionedArrayTest, SnapshotsKeepTheirVersion) {
+    ConcurrentFigureArray array;
+    array.addFigure(diamond(0, 0, 1));
+    uint64_t first = array.addFigure(std::make_shared<Trapezoid>(Point(0,0), Point(4,0), Point(3,2), Point(1,2)));
+    auto report = array.snapshot();
+    EXPECT_EQ(report.version(), first);
+
+    array.setVertex(1, 2, Point(3.5, 2));
+    array.removeFigure(0);
+    array.addFigure(diamond(9, 9, 2));
+    EXPECT_EQ(array.version(), first + 3);
+    EXPECT_EQ(array.retainedVersions(), 2u);
+
+    ASSERT_EQ(report->size(), 2u);
+    EXPECT_EQ(report->at(1)->getVertex(2), Point(3, 2));
+    EXPECT_EQ(array.snapshot(first)->size(), 2u);
+    EXPECT_EQ(array.snapshot()->at(0)->getVertex(2), Point(3.5, 2));
+    EXPECT_EQ(array.snapshot()->at(1).get(), array.snapshot(first + 3)->at(1).get());
+    EXPECT_THROW(array.snapshot(first + 1), std::out_of_range);
+
+    report = array.snapshot();
+    array.addFigure(diamond(1, 1, 1));
+    EXPECT_THROW(array.snapshot(first), std::out_of_range);
+    EXPECT_EQ(array.retainedVersions(), 2u);
+}
+
+TEST(VersionedArrayTest, LongReportSeesOneVersionWhileEditing) {
+    ConcurrentFigureArray array;
+    array.update([](FigureArray& figures) {
+        for (int i = 0; i < 5000; ++i) {
+            figures.addFigure(diamond(i, 0, 1));
+        }
+    });
+    std::atomic<bool> done(false);
+    std::atomic<size_t> errors(0);
+    std::thread report([&]() {
+        while (!done.load()) {
+            auto snapshot = array.snapshot();
+            double expected = 2.0 * snapshot->size();
+            for (int pass = 0; pass < 3; ++pass) {
+                if (snapshot->totalArea() != expected) {
+                    ++errors;
+                }
+            }
+        }
+    });
+    for (int i = 0; i < 500; ++i) {
+        array.removeFigure(i * 3 % 4000);
+        array.addFigure(diamond(-i, 5, 1));
+    }
+    done = true;
+    report.join();
+    EXPECT_EQ(errors.load(), 0u);
+    EXPECT_EQ(array.snapshot()->size(), 5000u);
+    EXPECT_EQ(array.retainedVersions(), 1u);
+    array.reclaim();
+    EXPECT_EQ(array.pendingVersions(), 0u);
+}
+
+TEST(IngestTest, ProducersPublishInSequenceOrder) {
+    const int producers = 6;
+    const int perProducer = 2000;
+    FigureIngest ingest(true);
+    FigureArray figures;
+    std::atomic<int> finished(0);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p]() {
+            auto producer = ingest.producer(64);
+            for (int i = 0; i < perProducer; ++i) {
+                uint64_t sequence = uint64_t(i) * producers + p;
+                producer.push(sequence, diamond(double(sequence), 0, 1));
+            }
+            producer.flush();
+            ++finished;
+        });
+    }
+    while (finished.load() < producers) {
+        ingest.drainInto(figures);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    ingest.drainInto(figures);
+    ASSERT_EQ(figures.size(), size_t(producers * perProducer));
+    EXPECT_EQ(ingest.waitingCount(), 0u);
+    for (size_t i = 0; i < figures.size(); ++i) {
+        ASSERT_EQ(figures.at(i)->geometricCenter().x, double(i)) << i;
+    }
+}
+
+TEST(IngestTest, GapHoldsBackLaterSequences) {
+    FigureIngest ingest(true, 10);
+    FigureArray figures;
+    {
+        auto producer = ingest.producer(2);
+        EXPECT_THROW(producer.push(diamond(0, 0, 1)), std::logic_error);
+        producer.push(12, diamond(12, 0, 1));
+        producer.push(10, diamond(10, 0, 1));
+        producer.push(13, diamond(13, 0, 1));
+        EXPECT_EQ(ingest.activeProducers(), 1u);
+    }
+    EXPECT_EQ(ingest.activeProducers(), 0u);
+    EXPECT_EQ(ingest.drainInto(figures), 1u);
+    EXPECT_EQ(ingest.waitingCount(), 2u);
+    {
+        auto producer = ingest.producer();
+        producer.push(10, diamond(-10, 0, 1)); // уже выдан
+        producer.push(12, diamond(-12, 0, 1)); // повтор ждущего номера
+        producer.push(11, diamond(11, 0, 1));
+    }
+    EXPECT_EQ(ingest.drainInto(figures), 3u);
+    EXPECT_EQ(ingest.staleCount(), 2u);
+    EXPECT_EQ(ingest.waitingCount(), 0u);
+    ASSERT_EQ(figures.size(), 4u);
+    for (size_t i = 0; i < figures.size(); ++i) {
+        EXPECT_EQ(figures.at(i)->geometricCenter(), Point(10 + i, 0));
+    }
+
+    FigureIngest unordered;
+    unordered.producer().push(diamond(0, 0, 1));
+    EXPECT_EQ(unordered.drainInto(figures), 1u);
+}
+
+TEST(ShardedCollectionTest, FanOutMatchesSingleArray) {
+    ShardedFigureCollection shards(4, ShardKey::SPATIAL, 10);
+    FigureArray plain;
+    std::vector<uint64_t> ids;
+    for (int i = 0; i < 400; ++i) {
+        auto fig = diamond(i % 40 * 3, i / 40 * 3, 1 + i % 3);
+        plain.addFigure(fig);
+        ids.push_back(shards.addFigure(fig));
+    }
+    EXPECT_EQ(shards.shardOf(ids[0]), shards.shardOf(ids[1]));
+    Query query = Query::parse("area > 3 && x < 60");
+    EXPECT_EQ(shards.count(query), query.compile().count(plain));
+    EXPECT_DOUBLE_EQ(shards.totalArea(), plain.totalArea());
+
+    for (int i = 0; i < 400; i += 2) {
+        EXPECT_TRUE(shards.removeFigure(ids[i]));
+    }
+    EXPECT_FALSE(shards.removeFigure(ids[0]));
+    EXPECT_EQ(shards.find(ids[0]), nullptr);
+    EXPECT_EQ(shards.find(ids[1]).get(), plain.at(1).get());
+    EXPECT_THROW(shards.setVertex(ids[0], 0, Point(0, 0)), std::out_of_range);
+    std::vector<uint64_t> expected;
+    for (int i = 1; i < 400; i += 2) {
+        if (query.compile().matches(*plain.at(i))) {
+            expected.push_back(ids[i]);
+        }
+    }
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(shards.select(query), expected);
+    EXPECT_EQ(shards.size(), 200u);
+    EXPECT_EQ(shards.snapshot().size(), 200u);
+}
+
+TEST(ShardedCollectionTest, SpatialShardsArePrunedAndFollowEdits) {
+    ShardedFigureCollection shards(16, ShardKey::SPATIAL, 100);
+    FigureArray plain;
+    for (int i = 0; i < 1600; ++i) {
+        auto fig = diamond(i % 40 * 25, i / 40 * 25, 2);
+        plain.addFigure(fig);
+        shards.addFigure(fig);
+    }
+    Query window = Query::parse("bbox intersects [10, 10, 60, 60]");
+    EXPECT_LT(shards.candidateShards(window).size(), shards.shardCount());
+    EXPECT_EQ(shards.count(window), window.compile().count(plain));
+
+    uint64_t moved = shards.addFigure(std::make_shared<Trapezoid>(Point(0,0), Point(4,0), Point(3,2), Point(1,2)));
+    size_t home = shards.shardOf(moved);
+    for (size_t v = 0; v < 4; ++v) { // переносим трапецию через всю сетку
+        Point p = shards.find(moved)->getVertex(v);
+        shards.setVertex(moved, v, Point(p.x + 2000, p.y + 2000));
+    }
+    Query far = Query::parse("bbox within [1990, 1990, 2010, 2010]");
+    EXPECT_EQ(shards.select(far), std::vector<uint64_t>{moved});
+    EXPECT_NE(shards.shardOf(moved), home);
+    EXPECT_EQ(shards.size(), 1601u);
+}
+
+TEST(ShardedCollectionTest, QueriesSeeMovingFiguresExactlyOnce) {
+    ShardedFigureCollection shards(16, ShardKey::SPATIAL, 100);
+    for (int i = 0; i < 200; ++i) {
+        shards.addFigure(diamond(i % 20 * 50, i / 20 * 50, 2));
+    }
+    std::vector<uint64_t> moving;
+    for (int i = 0; i < 4; ++i) {
+        moving.push_back(shards.addFigure(
+            std::make_shared<Trapezoid>(Point(0,0), Point(4,0), Point(3,2), Point(1,2))));
+    }
+    std::atomic<bool> done(false);
+    std::atomic<int> wrong(0);
+    std::thread reader([&]() {
+        Query all = Query::parse("bbox intersects [-5000, -5000, 5000, 5000]");
+        while (!done.load()) {
+            if (shards.count(all) != 204u || shards.select(all).size() != 204u) {
+                ++wrong;
+            }
+        }
+    });
+    std::vector<std::thread> writers;
+    for (uint64_t id : moving) {
+        writers.emplace_back([&, id]() {
+            for (int round = 0; round < 200; ++round) { // туда и обратно через ячейки
+                double shift = round % 2 ? -1000 : 1000;
+                for (size_t v = 0; v < 4; ++v) {
+                    Point p = shards.find(id)->getVertex(v);
+                    shards.setVertex(id, v, Point(p.x + shift, p.y + shift));
+                }
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    done = true;
+    reader.join();
+    EXPECT_EQ(wrong.load(), 0);
+
+    // HASH: сегмент зависит только от идентификатора.
+    ShardedFigureCollection hashed(8);
+    uint64_t id = hashed.addFigure(std::make_shared<Trapezoid>(Point(0,0), Point(4,0), Point(3,2), Point(1,2)));
+    size_t home = hashed.shardOf(id);
+    hashed.setVertex(id, 2, Point(3.5, 2));
+    EXPECT_EQ(hashed.shardOf(id), home);
+}
+
+TEST(ShardedCollectionTest, ConcurrentWritersAndQueries) {
+    ShardedFigureCollection shards(8);
+    std::atomic<bool> done(false);
+    std::thread reader([&]() {
+        Query all = Query::parse("area > 0");
+        while (!done.load()) {
+            shards.count(all);
+        }
+    });
+    std::vector<std::thread> writers;
+    for (int w = 0; w < 4; ++w) {
+        writers.emplace_back([&, w]() {
+            std::vector<uint64_t> mine;
+            for (int i = 0; i < 1000; ++i) {
+                mine.push_back(shards.addFigure(diamond(w * 1000 + i, i, 1)));
+            }
+            for (size_t i = 0; i < mine.size(); i += 4) {
+                shards.removeFigure(mine[i]);
+            }
+            uint64_t trapezoid = shards.addFigure(
+                std::make_shared<Trapezoid>(Point(0,0), Point(4,0), Point(3,2), Point(1,2)));
+            shards.setVertex(trapezoid, 2, Point(3.5, 2));
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    done = true;
+    reader.join();
+    EXPECT_EQ(shards.size(), 3004u);
+    EXPECT_DOUBLE_EQ(shards.totalArea(), 3000 * 2 + 4 * 6.5);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();